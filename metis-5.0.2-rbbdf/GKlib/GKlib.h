@@ -74,6 +74,7 @@
 #include <gk_mkpqueue.h>
 #include <gk_mkrandom.h>
 #include <gk_mkutils.h>
+#include <gk_mkvarint.h>
 
 #include <gk_proto.h>
 
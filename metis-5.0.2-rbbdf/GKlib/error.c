@@ -25,11 +25,23 @@ __thread jmp_buf gk_jbuf;
 
 typedef void (*gksighandler_t)(int);
 
-/* These are the holders of the old singal handlers for the trapped signals */
-static __thread gksighandler_t old_SIGMEM_handler;  /* Custom signal */
-static __thread gksighandler_t old_SIGERR_handler;  /* Custom signal */
-static __thread gksighandler_t old_SIGMEM_handlers[MAX_JBUFS];  /* Custom signal */
-static __thread gksighandler_t old_SIGERR_handlers[MAX_JBUFS];  /* Custom signal */
+/* These are the holders of the old singal handlers for the trapped signals.
+   Signal handlers are process-wide, so they are installed by the first thread
+   that sets a trap and restored by the last thread that removes its traps;
+   gk_ntrapped counts the threads with traps and is guarded by gk_traplock. */
+static gksighandler_t old_SIGMEM_handler;  /* Custom signal */
+static gksighandler_t old_SIGERR_handler;  /* Custom signal */
+static int gk_ntrapped = 0;
+static volatile int gk_traplock = 0;
+
+#ifdef __MSC__
+#include <intrin.h>
+#define gk_traplock_set()    while (_InterlockedExchange((long volatile *)&gk_traplock, 1))
+#define gk_traplock_unset()  _InterlockedExchange((long volatile *)&gk_traplock, 0)
+#else
+#define gk_traplock_set()    while (__sync_lock_test_and_set(&gk_traplock, 1))
+#define gk_traplock_unset()  __sync_lock_release(&gk_traplock)
+#endif
 
 /* The following is used to control if the gk_errexit() will actually abort or not.
    There is always a single copy of this variable */
@@ -100,10 +112,14 @@ int gk_sigtrap()
   if (gk_cur_jbufs+1 >= MAX_JBUFS)
     return 0;
 
-  gk_cur_jbufs++;
-
-  old_SIGMEM_handlers[gk_cur_jbufs]  = signal(SIGMEM,  gk_sigthrow);
-  old_SIGERR_handlers[gk_cur_jbufs]  = signal(SIGERR,  gk_sigthrow);
+  if (++gk_cur_jbufs == 0) {
+    gk_traplock_set();
+    if (gk_ntrapped++ == 0) {
+      old_SIGMEM_handler = signal(SIGMEM,  gk_sigthrow);
+      old_SIGERR_handler = signal(SIGERR,  gk_sigthrow);
+    }
+    gk_traplock_unset();
+  }
 
   return 1;
 }
@@ -118,10 +134,14 @@ int gk_siguntrap()
   if (gk_cur_jbufs == -1)
     return 0;
 
-  signal(SIGMEM,  old_SIGMEM_handlers[gk_cur_jbufs]);
-  signal(SIGERR,  old_SIGERR_handlers[gk_cur_jbufs]);
-
-  gk_cur_jbufs--;
+  if (gk_cur_jbufs-- == 0) {
+    gk_traplock_set();
+    if (--gk_ntrapped == 0) {
+      signal(SIGMEM,  old_SIGMEM_handler);
+      signal(SIGERR,  old_SIGERR_handler);
+    }
+    gk_traplock_unset();
+  }
 
   return 1;
 }
@@ -129,11 +149,17 @@ int gk_siguntrap()
 
 /*************************************************************************/
 /*! This function is the custome signal handler, which all it does is to
-    perform a longjump to the most recent saved environment 
+    perform a longjump to the most recent saved environment. A thread
+    without a trap of its own gets the default action of the signal.
  */
 /*************************************************************************/
 void gk_sigthrow(int signum)
 {
+  if (gk_cur_jbufs == -1) {
+    signal(signum, SIG_DFL);
+    raise(signum);
+  }
+
   longjmp(gk_jbufs[gk_cur_jbufs], signum);
 }
   
@@ -0,0 +1,108 @@
+/*!
+\file  gk_mkvarint.h
+\brief Templates for the delta-varint encoding of integer arrays
+
+Each value is stored as the difference from the previous one (the first
+from 0). The difference is zig-zag mapped, so that small negative ones
+stay small, and written 7 bits per byte with the high bit set on all but
+the last byte. A value takes at most GK_VMAXBYTES bytes.
+
+\date   Started 10/17/2026
+*/
+
+#ifndef _GK_MKVARINT_H_
+#define _GK_MKVARINT_H_
+
+#define GK_VMAXBYTES              10
+#define GK_VNFRAMES(n, fsize)     (((n)+(fsize)-1)/(fsize))
+
+#define GK_ZIGZAG(u)    (((u)<<1) ^ ((uint64_t)0 - ((u)>>63)))
+#define GK_UNZIGZAG(z)  (((z)>>1) ^ ((uint64_t)0 - ((z)&1)))
+
+
+#define GK_MKVARINT(PRFX, TYPE) \
+/*************************************************************************/\
+/*! The macro for gk_?vsize()-class of routines. It returns the # of   */\
+/*! bytes of the encoding of x[n]. */\
+/*************************************************************************/\
+size_t PRFX ## vsize(size_t n, TYPE *x)\
+{\
+  size_t i, nbytes=0;\
+  uint64_t u, prev=0;\
+\
+  for (i=0; i<n; i++) {\
+    u = (uint64_t)(int64_t)x[i];\
+    u = GK_ZIGZAG(u - prev);\
+    prev = (uint64_t)(int64_t)x[i];\
+    for (nbytes++; u >= 0x80; u >>= 7)\
+      nbytes++;\
+  }\
+\
+  return nbytes;\
+}\
+\
+\
+/*************************************************************************/\
+/*! The macro for gk_?vencode()-class of routines. It encodes x[n] into */\
+/*! out and returns the # of bytes written. */\
+/*************************************************************************/\
+size_t PRFX ## vencode(size_t n, TYPE *x, unsigned char *out)\
+{\
+  size_t i, k=0;\
+  uint64_t u, prev=0;\
+\
+  for (i=0; i<n; i++) {\
+    u = (uint64_t)(int64_t)x[i];\
+    u = GK_ZIGZAG(u - prev);\
+    prev = (uint64_t)(int64_t)x[i];\
+    for (; u >= 0x80; u >>= 7)\
+      out[k++] = (unsigned char)(u | 0x80);\
+    out[k++] = (unsigned char)u;\
+  }\
+\
+  return k;\
+}\
+\
+\
+/*************************************************************************/\
+/*! The macro for gk_?vdecode()-class of routines. It decodes n values */\
+/*! from the size bytes of in and returns the # of bytes read, or -1 if */\
+/*! the input is truncated or malformed. */\
+/*************************************************************************/\
+ssize_t PRFX ## vdecode(size_t n, unsigned char *in, size_t size, TYPE *x)\
+{\
+  size_t i, k=0;\
+  int shift;\
+  uint64_t u, b, prev=0;\
+\
+  for (i=0; i<n; i++) {\
+    if (k == size)\
+      return -1;\
+    u = in[k++];\
+    if (u >= 0x80) {\
+      u &= 0x7f;\
+      shift = 7;\
+      do {\
+        if (k == size || shift > 63)\
+          return -1;\
+        b = in[k++];\
+        u |= (b&0x7f) << shift;\
+        shift += 7;\
+      } while (b >= 0x80);\
+    }\
+    prev += GK_UNZIGZAG(u);\
+    x[i] = (TYPE)(int64_t)prev;\
+  }\
+\
+  return (ssize_t)k;\
+}\
+
+
+
+#define GK_MKVARINT_PROTO(PRFX, TYPE) \
+  size_t   PRFX ## vsize(size_t n, TYPE *x);\
+  size_t   PRFX ## vencode(size_t n, TYPE *x, unsigned char *out);\
+  ssize_t  PRFX ## vdecode(size_t n, unsigned char *in, size_t size, TYPE *x);\
+
+
+#endif
@@ -85,6 +85,9 @@ void   gk_AllocMatrix(void ***, size_t, size_t , size_t);
 void   gk_FreeMatrix(void ***, size_t, size_t);
 int    gk_malloc_init();
 void   gk_malloc_cleanup(int showstats);
+gk_mcore_t *gk_malloc_detach();
+void   gk_malloc_attach(gk_mcore_t *mcore);
+void   gk_malloc_adopt(gk_mcore_t *mcore);
 void  *gk_malloc(size_t nbytes, char *msg);
 void  *gk_realloc(void *oldptr, size_t nbytes, char *msg);
 void   gk_free(void **ptr1,...);
@@ -245,6 +248,20 @@ void decodeblock(unsigned char *in, unsigned char *out);
 void GKEncodeBase64(int nbytes, unsigned char *inbuffer, unsigned char *outbuffer);
 void GKDecodeBase64(int nbytes, unsigned char *inbuffer, unsigned char *outbuffer);
 
+/*-------------------------------------------------------------
+ * varint.c
+ *-------------------------------------------------------------*/
+GK_MKVARINT_PROTO(gk_i32, int32_t)
+GK_MKVARINT_PROTO(gk_i64, int64_t)
+int64_t gk_i32vencodeframes(size_t n, size_t fsize, int32_t *x, int64_t *fptr, 
+            unsigned char *out);
+int gk_i32vdecodeframes(size_t n, size_t fsize, unsigned char *in, int64_t *fptr, 
+        int32_t *x);
+int64_t gk_i64vencodeframes(size_t n, size_t fsize, int64_t *x, int64_t *fptr, 
+            unsigned char *out);
+int gk_i64vdecodeframes(size_t n, size_t fsize, unsigned char *in, int64_t *fptr, 
+        int64_t *x);
+
 
 /*-------------------------------------------------------------
  * random.c
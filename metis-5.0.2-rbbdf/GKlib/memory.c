@@ -127,6 +127,57 @@ void gk_malloc_cleanup(int showstats)
 }
 
 
+/*************************************************************************/
+/*! This function detaches the calling thread's gkmcore and returns it.
+    Heap allocations are not tracked until gk_malloc_init() or
+    gk_malloc_attach() is called again.
+*/
+/*************************************************************************/
+gk_mcore_t *gk_malloc_detach()
+{
+  gk_mcore_t *mcore = gkmcore;
+
+  gkmcore = NULL;
+
+  return mcore;
+}
+
+
+/*************************************************************************/
+/*! This function makes mcore the gkmcore of the calling thread.
+*/
+/*************************************************************************/
+void gk_malloc_attach(gk_mcore_t *mcore)
+{
+  gkmcore = mcore;
+}
+
+
+/*************************************************************************/
+/*! This function transfers the live heap allocations recorded in mcore
+    (typically detached from another thread) to the calling thread's 
+    gkmcore and destroys mcore. 
+*/
+/*************************************************************************/
+void gk_malloc_adopt(gk_mcore_t *mcore)
+{
+  size_t i;
+
+  if (mcore == NULL)
+    return;
+
+  if (gkmcore != NULL) {
+    for (i=0; i<mcore->cmop; i++) {
+      if (mcore->mops[i].type == GK_MOPT_HEAP)
+        gk_gkmcoreAdd(gkmcore, GK_MOPT_HEAP, mcore->mops[i].nbytes, mcore->mops[i].ptr);
+    }
+  }
+
+  free(mcore->mops);
+  free(mcore);
+}
+
+
 /*************************************************************************/
 /*! This function is my wrapper around malloc that provides the following
     enhancements over malloc:
@@ -8,6 +8,11 @@
 \version\verbatim $Id: random.c 10711 2011-08-31 22:23:04Z karypis $ \endverbatim
 */
 
+/* Get random_r() to be defined. */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#undef _GNU_SOURCE
+
 #include <GKlib.h>
 
 
@@ -60,10 +65,28 @@ GK_MKRANDOM(gk_idx, size_t, gk_idx_t)
 #define LM 0x7FFFFFFFULL /* Least significant 31 bits */
 
 
-/* The array for the state vector */
-static uint64_t mt[NN]; 
+/* The array for the state vector (per-thread, so that OpenMP threads 
+   draw from independent and reproducible streams) */
+static __thread uint64_t mt[NN]; 
 /* mti==NN+1 means mt[NN] is not initialized */
-static int mti=NN+1; 
+static __thread int mti=NN+1; 
+#elif defined(__GLIBC__)
+/* rand() shares one state across the threads of the process, so each thread
+   draws from its own random_r() state, which srandom() seeds just as srand() */
+static __thread struct random_data rdata;
+static __thread char rstate[128];
+static __thread int rinit=0;
+
+static int32_t gk_rand(void)
+{
+  int32_t r;
+
+  if (!rinit)
+    gk_randinit(1);
+  random_r(&rdata, &r);
+
+  return r;
+}
 #endif /* USE_GKRAND */
 
 /* initializes mt[NN] with a seed */
@@ -73,6 +96,10 @@ void gk_randinit(uint64_t seed)
   mt[0] = seed;
   for (mti=1; mti<NN; mti++) 
     mt[mti] = (6364136223846793005ULL * (mt[mti-1] ^ (mt[mti-1] >> 62)) + mti);
+#elif defined(__GLIBC__)
+  memset((void *)&rdata, 0, sizeof(rdata));
+  initstate_r((unsigned int) seed, rstate, sizeof(rstate), &rdata);
+  rinit = 1;
 #else
   srand((unsigned int) seed);
 #endif
@@ -115,6 +142,9 @@ uint64_t gk_randint64(void)
   x ^= (x >> 43);
 
   return x & 0x7FFFFFFFFFFFFFFF;
+#elif defined(__GLIBC__)
+  uint64_t hi = (uint64_t)gk_rand();
+  return hi << 32 | (uint64_t)gk_rand();
 #else
   return (uint64_t)(((uint64_t) rand()) << 32 | ((uint64_t) rand()));
 #endif
@@ -125,6 +155,8 @@ uint32_t gk_randint32(void)
 {
 #ifdef USE_GKRAND
   return (uint32_t)(gk_randint64() & 0x7FFFFFFF);
+#elif defined(__GLIBC__)
+  return (uint32_t)gk_rand();
 #else
   return (uint32_t)rand();
 #endif
@@ -0,0 +1,124 @@
+/*!
+\file  varint.c
+\brief Delta-varint encoding of integer arrays
+
+The arrays are encoded as independent frames of fsize values, each one
+starting its differences from 0. fptr[nframes+1] holds the offset of 
+each frame in the encoded bytes, so the frames can be encoded and 
+decoded in parallel. The format of the values is described in 
+gk_mkvarint.h.
+
+\date   Started 10/17/2026
+*/
+
+#include <GKlib.h>
+
+
+/*************************************************************************/
+/*! Use the templates to generate the routines for the integer types */
+/*************************************************************************/
+GK_MKVARINT(gk_i32, int32_t)
+GK_MKVARINT(gk_i64, int64_t)
+
+
+
+/*************************************************************************/
+/*! This function encodes x[n] as frames of fsize values. fptr must have
+    room for GK_VNFRAMES(n, fsize)+1 entries. If out is NULL, only fptr 
+    is computed, which gives the size of out. 
+    \returns the total # of bytes of the frames. */
+/*************************************************************************/
+int64_t gk_i32vencodeframes(size_t n, size_t fsize, int32_t *x, int64_t *fptr, 
+            unsigned char *out)
+{
+  ssize_t f, nframes;
+
+  nframes = GK_VNFRAMES(n, fsize);
+
+  fptr[0] = 0;
+  #pragma omp parallel for schedule(dynamic) if (nframes > 1)
+  for (f=0; f<nframes; f++) 
+    fptr[f+1] = gk_i32vsize(gk_min(fsize, n-f*fsize), x+f*fsize);
+  for (f=0; f<nframes; f++) 
+    fptr[f+1] += fptr[f];
+
+  if (out != NULL) {
+    #pragma omp parallel for schedule(dynamic) if (nframes > 1)
+    for (f=0; f<nframes; f++) 
+      gk_i32vencode(gk_min(fsize, n-f*fsize), x+f*fsize, out+fptr[f]);
+  }
+
+  return fptr[nframes];
+}
+
+
+/*************************************************************************/
+/*! This function decodes the frames written by gk_i32vencodeframes().
+    \returns 1 if every frame decoded to exactly its bytes, 0 otherwise. */
+/*************************************************************************/
+int gk_i32vdecodeframes(size_t n, size_t fsize, unsigned char *in, int64_t *fptr, 
+        int32_t *x)
+{
+  ssize_t f, nframes;
+  int ok=1;
+
+  nframes = GK_VNFRAMES(n, fsize);
+
+  #pragma omp parallel for schedule(dynamic) reduction(&:ok) if (nframes > 1)
+  for (f=0; f<nframes; f++) 
+    ok &= (fptr[f+1] >= fptr[f] && 
+           gk_i32vdecode(gk_min(fsize, n-f*fsize), in+fptr[f], fptr[f+1]-fptr[f], 
+               x+f*fsize) == fptr[f+1]-fptr[f]);
+
+  return ok;
+}
+
+
+/*************************************************************************/
+/*! This function encodes x[n] as frames of fsize values. 
+    See gk_i32vencodeframes(). */
+/*************************************************************************/
+int64_t gk_i64vencodeframes(size_t n, size_t fsize, int64_t *x, int64_t *fptr, 
+            unsigned char *out)
+{
+  ssize_t f, nframes;
+
+  nframes = GK_VNFRAMES(n, fsize);
+
+  fptr[0] = 0;
+  #pragma omp parallel for schedule(dynamic) if (nframes > 1)
+  for (f=0; f<nframes; f++) 
+    fptr[f+1] = gk_i64vsize(gk_min(fsize, n-f*fsize), x+f*fsize);
+  for (f=0; f<nframes; f++) 
+    fptr[f+1] += fptr[f];
+
+  if (out != NULL) {
+    #pragma omp parallel for schedule(dynamic) if (nframes > 1)
+    for (f=0; f<nframes; f++) 
+      gk_i64vencode(gk_min(fsize, n-f*fsize), x+f*fsize, out+fptr[f]);
+  }
+
+  return fptr[nframes];
+}
+
+
+/*************************************************************************/
+/*! This function decodes the frames written by gk_i64vencodeframes().
+    See gk_i32vdecodeframes(). */
+/*************************************************************************/
+int gk_i64vdecodeframes(size_t n, size_t fsize, unsigned char *in, int64_t *fptr, 
+        int64_t *x)
+{
+  ssize_t f, nframes;
+  int ok=1;
+
+  nframes = GK_VNFRAMES(n, fsize);
+
+  #pragma omp parallel for schedule(dynamic) reduction(&:ok) if (nframes > 1)
+  for (f=0; f<nframes; f++) 
+    ok &= (fptr[f+1] >= fptr[f] && 
+           gk_i64vdecode(gk_min(fsize, n-f*fsize), in+fptr[f], fptr[f+1]-fptr[f], 
+               x+f*fsize) == fptr[f+1]-fptr[f]);
+
+  return ok;
+}
@@ -165,6 +165,38 @@ typedef __int64 int64_t;
 /* evison */
 #define DIVIDER 100000000
 
+
+/*------------------------------------------------------------------------
+* Data structures
+*-------------------------------------------------------------------------*/
+/*! The statistics of a METIS_NodeBDF() call, filled per call so that
+    concurrent calls do not share any state */
+typedef struct {
+  real_t parttimer;	/*!< Time spent bisecting the candidate blocks */
+  real_t nztimer;	/*!< Time spent counting the non-zeros of the new blocks */
+  idx_t totalcheck;	/*!< Rounds that looked for a split */
+  idx_t firsthit;	/*!< Rounds that split the largest candidate block */
+  idx_t maxarea, minarea, maxnz, minnz;
+  real_t avgarea, avgnz;
+  real_t maxdense, mindense;
+} bdfstats_t;
+
+/*! The block diagonals returned by METIS_NodeBDF(). The rows of block i
+    are rind[rptr[i]..rptr[i+1]-1] and its columns cind[cptr[i]..cptr[i+1]-1],
+    the ones of the block itself first and then the ones of its borders.
+    The arrays follow the structure in the same allocation, in the order
+    rptr, cptr, rind, cind, so the whole result is freed by a single
+    METIS_Free() and its 2*(ndiags+1)+nrind+ncind idx_t's starting at
+    rptr can be written out in one go */
+typedef struct {
+  idx_t ndiags;		/*!< The number of block diagonals */
+  idx_t nrind;		/*!< The length of rind, i.e., rptr[ndiags] */
+  idx_t ncind;		/*!< The length of cind, i.e., cptr[ndiags] */
+  idx_t *rptr, *cptr;
+  idx_t *rind, *cind;
+} bdfdiags_t;
+
+
 /*------------------------------------------------------------------------
 * Function prototypes 
 *-------------------------------------------------------------------------*/
@@ -214,7 +246,7 @@ METIS_API(int) METIS_NodeND(idx_t *nvtxs, idx_t *xadj, idx_t *adjncy, idx_t *vwg
 /*evison*/
 METIS_API(int) METIS_NodeBDF(idx_t *nvtxs, idx_t* xadj, idx_t* adjncy, idx_t *vwgt, idx_t nrows, idx_t ncols,
 		idx_t *options, idx_t *rlabel_label, idx_t rlabel_ref, idx_t *clabel_label, idx_t clabel_ref,
-		idx_t ***rdiags, idx_t ***cdiags, idx_t *ndiags, idx_t *perm, idx_t *iperm);
+		bdfdiags_t **diags, idx_t *perm, idx_t *iperm, bdfstats_t *stats);
 
 METIS_API(int) METIS_Free(void *ptr);
 
@@ -296,7 +328,16 @@ typedef enum {
   METIS_OPTION_KAPPA,
   METIS_OPTION_NROWS,
   METIS_OPTION_NCOLS,
-  METIS_OPTION_NDIAGS
+  METIS_OPTION_NDIAGS,
+  METIS_OPTION_NTHREADS,
+  METIS_OPTION_SELECT,
+  METIS_OPTION_INFORMAT,
+  METIS_OPTION_OUTFMT,
+  METIS_OPTION_SHARDS,
+  METIS_OPTION_SERVER,
+  METIS_OPTION_SOCKET,
+  METIS_OPTION_NWORKERS,
+  METIS_OPTION_INHERIT
 } moptions_et;
 
 
@@ -315,7 +356,8 @@ typedef enum {
 /*! Coarsening Schemes */
 typedef enum {
   METIS_CTYPE_RM,
-  METIS_CTYPE_SHEM
+  METIS_CTYPE_SHEM,
+  METIS_CTYPE_PHEM
 } mctype_et;
 
 /*! Initial partitioning schemes */
@@ -333,10 +375,41 @@ typedef enum {
   METIS_RTYPE_FM,
   METIS_RTYPE_GREEDY,
   METIS_RTYPE_SEP2SIDED,
-  METIS_RTYPE_SEP1SIDED
+  METIS_RTYPE_SEP1SIDED,
+  /*evison*/
+  METIS_RTYPE_SEPDENSE
 } mrtype_et;
 
 
+/*! Split selection schemes of RBBDF */
+typedef enum {
+  METIS_SELECT_FIRST,		/*!< The first split, in area order, that improves the density */
+  METIS_SELECT_BEST,		/*!< The split with the largest density gain */
+  METIS_SELECT_RATIO		/*!< The split with the largest density gain per unit of border area */
+} mselect_et;
+
+/*! Input formats of rbbdf */
+typedef enum {
+  METIS_INFORMAT_GRAPH,		/*!< A graph file, either text or binary */
+  METIS_INFORMAT_MATRIX,	/*!< A .matrix file, a dense binary matrix */
+  METIS_INFORMAT_TRIPLES	/*!< Lines of user item [rating] triples */
+} minformat_et;
+
+/*! Output formats of rbbdf */
+typedef enum {
+  METIS_OUTFMT_TEXT,		/*!< The .iperm and .diags text files */
+  METIS_OUTFMT_BIN,		/*!< The .iperm.bin and .diags.bin binary files */
+  METIS_OUTFMT_VARINT		/*!< The binary files with delta-varint encoded arrays */
+} moutfmt_et;
+
+/*! Per-block shard outputs of rbbdf */
+typedef enum {
+  METIS_SHARDS_NONE,		/*!< No shards are written */
+  METIS_SHARDS_BLOCK,		/*!< The rows and columns of a block that are in no other block */
+  METIS_SHARDS_BORDERED		/*!< All the rows and columns of a block, borders included */
+} mshards_et;
+
+
 /*! Debug Levels */
 typedef enum {
   METIS_DBG_INFO       = 1,       /*!< Shows various diagnostic messages */
@@ -1,5 +1,4 @@
 #include "metislib.h"
-#include "bmetis.h"
 #include "sys/malloc.h"
 /*************************************************************************/
 /*! This function is the entry point for the multilevel nested dissection
@@ -19,15 +18,21 @@
     \param options is an array of size METIS_NOPTIONS used to pass
            various options impacting the of the algorithm. A NULL
            value indicates use of default options.
+    \param r_diags returns the rows and columns of the block diagonals
+           in a single allocation (see bdfdiags_t), to be released by
+           METIS_Free(). It is NULL if an error occurs.
     \param perm is an array of size nvtxs such that if A and A' are
            the original and permuted matrices, then A'[i] = A[perm[i]].
     \param iperm is an array of size nvtxs such that if A and A' are
            the original and permuted matrices, then A[i] = A'[iperm[i]].
+    \param stats returns the statistics of this call, it can be NULL.
+           Nothing of the call is kept in global state, so concurrent
+           calls from different threads are independent.
 */
 /*************************************************************************/
 int METIS_NodeBDF(idx_t *nvtxs, idx_t* xadj, idx_t* adjncy, idx_t *vwgt, idx_t nrows, idx_t ncols,
 		idx_t *options, idx_t *rlabel_label, idx_t rlabel_ref, idx_t *clabel_label, idx_t clabel_ref,
-		idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags, idx_t *perm, idx_t *iperm){
+		bdfdiags_t **r_diags, idx_t *perm, idx_t *iperm, bdfstats_t *stats){
 
 	int sigrval = 0, renumber=0;
 	ctrl_t *ctrl;
@@ -36,22 +41,30 @@ int METIS_NodeBDF(idx_t *nvtxs, idx_t* xadj, idx_t* adjncy, idx_t *vwgt, idx_t n
 	graph_t *ograph = NULL;
 	idx_t nnvtxs;
 	label_t *rlabel, *clabel;
+	bdfstats_t lstats;
 	int i, j;
 
+	*r_diags = NULL;
+
+	memset((void *)&lstats, 0, sizeof(bdfstats_t));
+	lstats.maxarea = lstats.maxnz = -1;
+	lstats.minarea = lstats.minnz = IDX_MAX;
+	lstats.mindense = 1.0;
+
 	/* set up malloc cleaning code and signal catchers */
 	if (!gk_malloc_init())	return METIS_ERROR_MEMORY;
 
 	gk_sigtrap();
 
 	if ((sigrval = gk_sigcatch()) != 0)	goto SIGTHROW;
-
-	/*1-ncon 3-nparts*/	/*TODO can nparts be assigned other numbers?*/
+	/* 1-ncon 3-nparts of the node bisections, the k-way splits set up their own ctrl */
 	ctrl = SetupCtrl(METIS_OP_BMETIS, options, 1, 3, NULL, NULL);
 	if (!ctrl) {
 		gk_siguntrap();
 		gk_malloc_cleanup(0);
 		return METIS_ERROR_INPUT;
 	}
+	ctrl->stats = &lstats;
 
 	/* if required, change the numbering to 0 */
 	if (ctrl->numflag == 1) {
@@ -76,16 +89,19 @@ int METIS_NodeBDF(idx_t *nvtxs, idx_t* xadj, idx_t* adjncy, idx_t *vwgt, idx_t n
 
 	obigraph = SetupBiGraphFromGraph(ograph, nrows, ncols, ctrl->nrows, ctrl->ncols, rlabel, clabel);
 	ctrl->obigraph = obigraph;
+	ctrl->snz = obigraph->snz;
+	ctrl->sarea = obigraph->sarea;
 
 	ASSERT(CheckBiGraph(obigraph, ctrl->numflag, 1));	/* TODO debug */
 
 	/* allocate workspace memory */
   	AllocateWorkSpace(ctrl, obigraph->super);
+	ctrl->bndmark = ismalloc(*nvtxs, -1, "METIS_NodeBDF: bndmark");
 
   	if (ctrl->ccorder)
-		MlevelNestedBDFCC(ctrl, obigraph, iperm, 1, r_rdiags, r_cdiags, r_ndiags);
+		MlevelNestedBDFCC(ctrl, obigraph, iperm, 1, r_diags);
 	else
-		MlevelNestedBDF(ctrl, obigraph, iperm, 1, r_rdiags, r_cdiags, r_ndiags);
+		MlevelNestedBDF(ctrl, obigraph, iperm, 1, r_diags);
 
 	for (i = 0; i < *nvtxs; i++)
 		perm[iperm[i]] = i;
@@ -97,6 +113,9 @@ int METIS_NodeBDF(idx_t *nvtxs, idx_t* xadj, idx_t* adjncy, idx_t *vwgt, idx_t n
 
 	/* clean up */
 	FreeBiGraph(ctrl, &ctrl->obigraph);
+	for (i = 0; i < ctrl->nborders; i++)
+		gk_free((void **)&ctrl->borders[i].rlabel, &ctrl->borders[i].clabel, LTERM);
+	gk_free((void **)&ctrl->borders, &ctrl->bndmark, LTERM);
 	FreeCtrl(&ctrl);
 
 SIGTHROW:
@@ -106,6 +125,9 @@ SIGTHROW:
 	gk_siguntrap();
 	gk_malloc_cleanup(0);
 
+	if (stats != NULL)
+		*stats = lstats;
+
 	return metis_rcode(sigrval);
 }
 
@@ -116,200 +138,980 @@ SIGTHROW:
  * 	\param ctrl is the ctrl parameters for reordering
  * 	\param head is head of block list to reorder
  * 	\param order is for storing and returning current order of vertices
- * 	\param lastvtx is the last vertex index in this round
- * 	\param rdiags is for returning the row indices of block diagonals
- * 	\param cdiags is for returning the row indices of block diagonals
- * 	\param ndiags is for returning number of block diagonal extracted
+ * 	\param ndiags is the number of block diagonals in the list
+ * 	\param r_diags is for returning the rows and columns of the block diagonals
  *
- *	TODO In order to save memory, bigraph can be deleted in this
- *	function if a patition has been performed and the graph is split
- *	into several block diagonals, because we only need to keep track
- *	of current diagonals. But if so, we must make sure the memory is
- *	not refreed in main() function.
+ *	The block diagonals are split one per round, until the density
+ *	requirement is reached or no split improves the average density.
+ *	Each block diagonal has an id in [0, ndiags), the partible ones are
+ *	kept in a max-heap keyed by their area and then their id (see
+ *	BlockQueueInsert), so a round only pops the blocks it tries, and only
+ *	the new blocks are inserted after a split (the split block hands its
+ *	id to the first one).
+ *	ctrl->select tells which of the improving splits of a round is taken.
+ *	With ctrl->kappa > 2, a block whose k-way split does not improve the
+ *	average density is bisected instead, in a later round.
  *
- *	bigraph, rdiags, cdiags, ndiags have been initialized well.
+ *	bigraph and ndiags have been initialized well.
  ***********************************************************************/
 void MlevelNestedBDF(ctrl_t *ctrl, bigraph_t *head, idx_t *order, idx_t ndiags,
-		idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags){
-
-	real_t avgdensity, replacedensity, mindensity, tempdensity;
-	bigraph_t *lbigraph, *rbigraph, *temp, *p, *q;
-	bigraph_t **sort;
-	real_t *denses;
-	idx_t *areas;
-	graph_t *cgraph, *tosplit;
-	idx_t *cptr, *cind, *bndind, *label;
-	idx_t i, j, k, pos, nnvtxs, nbnd;
-	graph_t *lgraph, *rgraph, *swap;
-	idx_t partitioned = 0;
-
-	avgdensity = AverageDensity(head);
-	printf("ndiags = %d, avgdensity = %.6f, requirdensity = %.6f\n", ndiags, avgdensity, ctrl->density);
-
-	if( (ctrl->ndiags != -1 && ndiags >= ctrl->ndiags)
-			|| (ctrl->ndiags == -1 && avgdensity >= ctrl->density) ){
-		/* TODO debug */
-		sort = (bigraph_t**)gk_malloc(ndiags * sizeof(bigraph_t*), "MlevelNestedBDF : sorted diagonalas");
+		bdfdiags_t **r_diags){
+
+	real_t avgdensity;
+	bigraph_t **children, **bchildren, *p, *q;
+	bigraph_t **blocks, **cands;
+	idx_t *cids;
+	idx_t i, j, k, s, maxdiags, maxbisect, ntried, ncands, nbisect, nparts, nqueue;
+	idx_t nsnz, nsarea, narea, best, bnparts, bnsnz, bnsarea, bnarea, nretry;
+	real_t gain, score, bestscore;
+	graph_t **sgraphs;
+	ikv_t *queue;
+	idx_t reached = 0;
+
+	/* the arrays indexed by block id grow with ndiags, see the top of the
+	 * rounds. At most maxbisect candidates are bisected in a batch, each
+	 * into at most kappa subgraphs */
+	maxdiags = 2*ndiags + ctrl->kappa;
+	maxbisect = (ctrl->select == METIS_SELECT_FIRST ? ctrl->nthreads : maxdiags);
+
+	blocks    = (bigraph_t**)gk_malloc(maxdiags * sizeof(bigraph_t*), "MlevelNestedBDF: blocks");
+	cids      = imalloc(maxdiags, "MlevelNestedBDF: cids");
+	cands     = (bigraph_t**)gk_malloc(maxdiags * sizeof(bigraph_t*), "MlevelNestedBDF: cands");
+	sgraphs   = (graph_t**)gk_malloc(maxbisect * ctrl->kappa * sizeof(graph_t*), "MlevelNestedBDF: sgraphs");
+	children  = (bigraph_t**)gk_malloc(ctrl->kappa * sizeof(bigraph_t*), "MlevelNestedBDF: children");
+	bchildren = (bigraph_t**)gk_malloc(ctrl->kappa * sizeof(bigraph_t*), "MlevelNestedBDF: bchildren");
+	queue     = ikvmalloc(maxdiags, "MlevelNestedBDF: queue");
+
+	for (nqueue = 0, i = 0, p = head; p; p = p->next, i++) {
+		blocks[i] = p;
+		if (p->partible)
+			BlockQueueInsert(queue, &nqueue, i, p->area);
+	}
+	ASSERT(i == ndiags);
 
-		areas = (idx_t*)gk_malloc(ndiags * sizeof(idx_t), "MlevelNestedBDF : area list");
+	for (;;) {
+		avgdensity = AverageDensity(ctrl);
+		printf("ndiags = %d, avgdensity = %.6f, requirdensity = %.6f\n", ndiags, avgdensity, ctrl->density);
 
-		SortBlockDiagsBySingleArea(head, ndiags, sort, areas);
+		if( (ctrl->ndiags != -1 && ndiags >= ctrl->ndiags)
+				|| (ctrl->ndiags == -1 && avgdensity >= ctrl->density) ) {
+			reached = 1;
+			break;
+		}
 
-		OrderEachGraph(head, order);
-		ConstructResult(head, ndiags, r_rdiags, r_cdiags, r_ndiags);
+		/* a round tries at most ndiags blocks and adds at most kappa-1 ones */
+		if (ndiags + ctrl->kappa > maxdiags) {
+			maxdiags = 2*(ndiags + ctrl->kappa);
+			blocks = (bigraph_t**)gk_realloc(blocks, maxdiags * sizeof(bigraph_t*), "MlevelNestedBDF: blocks");
+			cids   = irealloc(cids, maxdiags, "MlevelNestedBDF: cids");
+			cands  = (bigraph_t**)gk_realloc(cands, maxdiags * sizeof(bigraph_t*), "MlevelNestedBDF: cands");
+			queue  = ikvrealloc(queue, maxdiags, "MlevelNestedBDF: queue");
+			if (ctrl->select != METIS_SELECT_FIRST) {
+				maxbisect = maxdiags;
+				sgraphs = (graph_t**)gk_realloc(sgraphs, maxbisect * ctrl->kappa * sizeof(graph_t*), "MlevelNestedBDF: sgraphs");
+			}
+		}
 
-		printf("***RETURN @1: Density requiment reached\n");
-		return;
-	}
+		ctrl->stats->totalcheck++;	/* TODO exp heuristic */
+		/* try to split the block diagonals from the largest one on. In the 'first'
+		 * mode the first split that improves the average density is taken, in the
+		 * other modes all partible blocks are tried and the split with the best
+		 * score (gain, or gain per unit of new border area) is taken.
+		 * A block whose bisection was rejected keeps it in cwhere/csnz/csarea, so it is
+		 * only re-scored against the current totals. The others are bisected in batches
+		 * of ctrl->nthreads ('first' mode) or all at once, and the batch is scanned in
+		 * heap order so that the first improving split still wins. The blocks tried in
+		 * this round and not split go back to the heap when the round is over.
+		 * The j-th bisected candidate of a batch returns its subgraphs in
+		 * sgraphs[j*kappa..(j+1)*kappa-1] */
+		best = -1;
+		bestscore = 0.0;
+		nretry = 0;
+		bchildren[0] = NULL;
+		bnparts = bnsnz = bnsarea = bnarea = 0;
+		for (ntried = 0; (best == -1 || ctrl->select != METIS_SELECT_FIRST) && nqueue > 0; ntried = ncands) {
+			for (ncands = ntried, nbisect = 0; nbisect < maxbisect && (i = BlockQueueGetTop(queue, &nqueue)) != -1; ) {
+				if (blocks[i]->cwhere == NULL)	nbisect++;
+				cids[ncands] = i;
+				cands[ncands++] = blocks[i];
+			}
 
-	/* Sort the block diagonals according to their densities, and save the sorted densities
-	 * in 'densities' and their corresponding pointers in 'sort'
-	 * TODO which block diagonal to choose? */
-
-	sort = (bigraph_t**)gk_malloc(ndiags * sizeof(bigraph_t*), "MlevelNestedBDF : sorted diagonalas");
-
-	areas = (idx_t*)gk_malloc(ndiags * sizeof(idx_t), "MlevelNestedBDF : area list");
-
-	SortBlockDiagsBySingleArea(head, ndiags, sort, areas);
-
-	_totalcheck++;	/* TODO exp heuristic */
-	/* try to split the block diagonals from the one with least average density on,
-	 * until the average density of the resulting blocks is improved*/
-	for (i = 0; i < ndiags; i++) {
-		if (!sort[i]->partible) continue;
-		/* The graph could not be compressed on the whole bipartie graph in advance,
-		 * because if an row vetex and a column vertex are compressed into one vertex,
-		 * then this would not be a biparatite graph any more !
-		 * Compress could be done here before each real partitioning, and the partition
-		 * result should be mapped back into orignal indices once finished. */
-		if (ctrl->compress) {
-			cptr = imalloc(sort[i]->super->nvtxs+1, "BMETIS: cptr");
-			cind = imalloc(sort[i]->super->nvtxs, "BMETIS: cind");
-
-			cgraph = CompressGraph(ctrl, sort[i]->super->nvtxs, sort[i]->super->xadj,
-					sort[i]->super->adjncy, sort[i]->super->vwgt, cptr, cind);
-			if (cgraph == NULL) {
-				/* if there was no compression, cleanup the compressed flag */
-				gk_free((void **)&cptr, &cind, LTERM);
-				ctrl->compressed = 0;
-				tosplit = sort[i]->super;
+			gk_startcputimer(ctrl->stats->parttimer);	/* TODO debug timer */
+			if (ctrl->nthreads == 1) {
+				for (j = 0, k = ntried; k < ncands; k++) {
+					if (cands[k]->cwhere != NULL)	continue;
+					InitRandom((ctrl->seed == -1 ? 4321 : ctrl->seed) + cands[k]->lastvtx);
+					SetupDensityBorders(ctrl, cands[k], ctrl);
+					BisectBlockDiag(ctrl, cands[k], sgraphs + (j++)*ctrl->kappa);
+				}
 			}
 			else {
-				nnvtxs = sort[i]->super->nvtxs;
-				ctrl->compressed = 1;
-				tosplit = cgraph;
-				/*
-				ctrl->cfactor = 1.0*(*graph->nvtxs)/nnvtxs;
-				if (ctrl->cfactor > 1.5 && ctrl->nseps == 1)	ctrl->nseps = 2;
-				*//* TODO */
+				BisectBlockDiagsP(ctrl, ncands-ntried, cands+ntried, sgraphs);
 			}
-		}
-		else {
-			ctrl->compressed = 0;
-			tosplit = sort[i]->super;
-		}
-
-		ASSERT(CheckGraph(tosplit, ctrl->numflag, 1));	/* TODO debug */
+			gk_stopcputimer(ctrl->stats->parttimer);
+
+			for (j = 0, k = ntried; k < ncands; k++) {
+				children[0] = NULL;
+
+				if (cands[k]->cwhere == NULL) {	/* bisected in this batch */
+					IFSET(ctrl->dbglvl, METIS_DBG_SEPINFO,
+			      		printf("Nvtxs: %6"PRIDX", [%6"PRIDX" %6"PRIDX" %6"PRIDX"]\n",
+			        		cands[k]->super->nvtxs, cands[k]->super->pwgts[0],
+			        		cands[k]->super->pwgts[1], cands[k]->super->pwgts[ctrl->kappa]));
+
+					nparts = RemoveEmptyGraphs(ctrl->kappa, sgraphs + j*ctrl->kappa);
+					if (nparts < 2){
+						cands[k]->partible = 0;
+						for (s = 0; s < nparts; s++)
+							FreeGraph(&sgraphs[j*ctrl->kappa+s]);
+						FreeRData(cands[k]->super);
+						j++;
+						continue;
+					}
+
+					/* construct the new bigraphs */
+					ExtractBiGraph(ctrl, cands[k], nparts, sgraphs + (j++)*ctrl->kappa, children);
+					for (nsnz = nsarea = narea = 0, s = 0; s < nparts; s++) {
+						nsnz += children[s]->snz;
+						nsarea += children[s]->sarea;
+						narea += children[s]->area;
+					}
+				}
+				else {	/* rejected before, re-score the cached bisection */
+					nparts = 0;
+					nsnz = cands[k]->csnz;
+					nsarea = cands[k]->csarea;
+					narea = cands[k]->carea;
+				}
 
-		gk_startcputimer(_parttimer);	/* TODO debug timer */
-		MlevelNodeBisectionMultipleBDF(ctrl, tosplit);
-		gk_stopcputimer(_parttimer);
+				/* check whether average density is improved, only the first one is taken
+				 * in the 'first' mode */
+				gain = AverageReplaceDensity(ctrl, cands[k], nsnz, nsarea) - avgdensity;
+
+				/* a rejected k-way split is dropped, and the block is bisected
+				 * the next time it is tried */
+				if (gain <= 0 && ctrl->kappa > 2 && !cands[k]->bisect
+						&& (best == -1 || ctrl->select != METIS_SELECT_FIRST)) {
+					cands[k]->bisect = 1;
+					nretry++;
+					if (children[0] == NULL) {
+						gk_free((void**)&cands[k]->cwhere, LTERM);
+					}
+					else {
+						for (s = 0; s < nparts; s++)
+							FreeBiGraph(ctrl, &children[s]);
+						FreeRData(cands[k]->super);
+					}
+					continue;
+				}
 
-		IFSET(ctrl->dbglvl, METIS_DBG_SEPINFO,
-      		printf("Nvtxs: %6"PRIDX", [%6"PRIDX" %6"PRIDX" %6"PRIDX"]\n",
-        		sort[i]->super->nvtxs, sort[i]->super->pwgts[0],
-        		sort[i]->super->pwgts[1], sort[i]->super->pwgts[2]));
-
-		/* extract resulting blocks diagonal list, note that compression may have been done */
-		if (ctrl->compressed) {
-			SplitGraphOrderUncompressBDF(ctrl, sort[i]->super, cgraph, cptr, cind, &lgraph, &rgraph);
-			FreeGraph(&cgraph);
-			gk_free((void **)&cptr, &cind, LTERM);
-		}
-		else {
-			gk_startcputimer(_parttimer);	/* TODO exp timer */
-			SplitGraphOrderBDF(ctrl, sort[i]->super, &lgraph, &rgraph);
-			/*swap = lgraph; lgraph = rgraph; rgraph = swap;*/
-			gk_stopcputimer(_parttimer);
-		}
+				if (gain > 0 && (best == -1 || ctrl->select != METIS_SELECT_FIRST)) {	/* if so */
+					score = gain;
+					if (ctrl->select == METIS_SELECT_RATIO)	/* the border area added by the split */
+						score /= gk_max(1, nsarea - narea - (cands[k]->sarea - cands[k]->area));
+
+					if (best == -1 || score > bestscore) {
+						if (best != -1)
+							CacheBisection(ctrl, cands[best], bnparts, bchildren, bnsnz, bnsarea, bnarea);
+						best = k;
+						bestscore = score;
+						bchildren[0] = NULL;	/* a cached bisection */
+						for (s = 0; s < nparts; s++)
+							bchildren[s] = children[s];
+						bnparts = nparts;
+						bnsnz = nsnz;	bnsarea = nsarea;	bnarea = narea;
+						continue;
+					}
+				}
 
-		if (lgraph->nvtxs == 0 || rgraph->nvtxs == 0){
-			sort[i]->partible = 0;
-			FreeGraph(&lgraph);
-			FreeGraph(&rgraph);
-			continue;
+				CacheBisection(ctrl, cands[k], nparts, children, nsnz, nsarea, narea);
+			}
 		}
 
-		/* construct new left and right bigraphs */
-		ExtractBiGraph(ctrl, sort[i], lgraph, rgraph, &lbigraph, &rbigraph);
-
-		/* check whether average density is improved */
-		replacedensity = AverageReplaceDensity (head, sort[i], lbigraph, rbigraph);
+		if (best != -1) {
+			k = best;
+			if (k == 0)	ctrl->stats->firsthit++;	/* TODO exp heuristic */
+
+			nparts = bnparts;
+			for (s = 0; s < nparts; s++)
+				children[s] = bchildren[s];
+			if (bchildren[0] == NULL) {
+				SplitCachedBisection(ctrl, cands[k], sgraphs);
+				nparts = RemoveEmptyGraphs(ctrl->kappa, sgraphs);
+				ExtractBiGraph(ctrl, cands[k], nparts, sgraphs, children);
+			}
+			ASSERT(nparts >= 2);
 
-		if (replacedensity > avgdensity) {	/* if so */
-			if (i == 0)	_firsthit++;	/* TODO exp heuristic */
-			partitioned = 1;
 			/* insert new bigraphs into block diagonal list */
-			p = head;	while (p && p != sort[i])	p = p->next;
+			p = head;	while (p && p != cands[k])	p = p->next;
 			if (p == NULL) { printf("***ERROR: p == NULL"); exit(-1); }	/* TODO debug */
+			for (s = 0; s < nparts-1; s++)
+				children[s]->next = children[s+1];
+			children[nparts-1]->next = p->next;
 			if (p == head) { /* p is head */
-				head = lbigraph;
-				lbigraph->next = rbigraph;
-				rbigraph->next = p->next;
+				head = children[0];
 			}
 			else {
 				q = head;	while (q->next != p)	q = q->next;
-				q->next = lbigraph;
-				lbigraph->next = rbigraph;
-				rbigraph->next = p->next;
+				q->next = children[0];
 			}
-			for (j = 0; j < sort[i]->super->nbnd; j++) {	/* manage order */
-				order[sort[i]->super->label[sort[i]->super->bndind[j]]] = --sort[i]->lastvtx;
+			for (j = 0; j < cands[k]->super->nbnd; j++) {	/* manage order */
+				order[cands[k]->super->label[cands[k]->super->bndind[j]]] = --cands[k]->lastvtx;
+			}
+			children[nparts-1]->lastvtx = cands[k]->lastvtx;
+			for (s = nparts-2; s >= 0; s--)
+				children[s]->lastvtx = children[s+1]->lastvtx - children[s+1]->super->nvtxs;
+
+			/* update the running totals of the block diagonal list */
+			for (s = 0; s < nparts; s++) {
+				ctrl->snz += children[s]->snz;
+				ctrl->sarea += children[s]->sarea;
+			}
+			ctrl->snz -= cands[k]->snz;
+			ctrl->sarea -= cands[k]->sarea;
+
+			/* the first block takes over the id of cands[k] */
+			blocks[cids[k]] = children[0];
+			BlockQueueInsert(queue, &nqueue, cids[k], children[0]->area);
+			for (s = 1; s < nparts; s++) {
+				blocks[ndiags] = children[s];
+				BlockQueueInsert(queue, &nqueue, ndiags, children[s]->area);
+				ndiags++;
 			}
-			rbigraph->lastvtx = sort[i]->lastvtx;
-			lbigraph->lastvtx = rbigraph->lastvtx - rbigraph->super->nvtxs;
 
-			/* release sort[i], but ctrl->obigraph should not be released */
-			FreeBiGraph(ctrl, &(sort[i]));
-			break;
+			/* release cands[k], but ctrl->obigraph should not be released */
+			FreeBiGraph(ctrl, &(cands[k]));
+			cids[k] = -1;
 		}
-		else {	/* else */
-			/* release memory of lbigrahp and rbigraph then try the next block diagonal */
-			FreeBiGraph(ctrl, &lbigraph);
-			FreeBiGraph(ctrl, &rbigraph);
+
+		for (k = 0; k < ntried; k++) {
+			if (cids[k] != -1 && cands[k]->partible)
+				BlockQueueInsert(queue, &nqueue, cids[k], cands[k]->area);
 		}
+
+		/* non of the diagonal block improves average density, and none is
+		 * left to bisect instead of splitting it k ways */
+		if (best == -1 && nretry == 0)
+			break;
 	}
 
-	gk_free((void**)&sort, &areas, LTERM);
+	/* manage order of each block diagonal graph */
+	OrderEachGraph(head, order);
+	*r_diags = ConstructResult(ctrl, head, ndiags);
 
-	if (partitioned) { /* recursive call */
-		MlevelNestedBDF(ctrl, head, order, ndiags+1, r_rdiags, r_cdiags, r_ndiags);
-	}
-	else {	/* non of the diagonal block improves average density */
-		/* manage order of each block diagonal graph */
-		OrderEachGraph(head, order);
-		ConstructResult(head, ndiags, r_rdiags, r_cdiags, r_ndiags);
+	gk_free((void**)&queue, &blocks, &cids, &cands, &sgraphs, &children, &bchildren, LTERM);
 
+	if (reached)
+		printf("***RETURN @1: Density requiment reached\n");
+	else
 		printf("***RETURN @2: Can not improve density any more.\n");
-		return;
-	}
 }
 
 /***********************************************************************
  * This functhion is similar to its non 'CC' version execpt that it
  * extracts connected components of a graph before reording.
  * 	\param ctrl is the ctrl parameters for reordering
- * 	\param head is the head of block list to reorder
+ * 	\param head is the head of block list to reorder, i.e. ctrl->obigraph
  * 	\param order is for storing and returning current order of vertices
- * 	\param lastvtx is the last vertex index in this round
- * 	\param rdiags is for returning the row indices of block diagonals
- * 	\param cdiags is for returning the row indices of block diagonals
- * 	\param ndiags is for returning number of block diagonal extracted
+ * 	\param ndiags is the number of block diagonals in the list
+ * 	\param r_diags is for returning the rows and columns of the block diagonals
  *
+ *	Each connected component is a block diagonal without any border, so
+ *	the components are taken as the initial block diagonals for free and
+ *	only they are bisected further by MlevelNestedBDF.
  ***********************************************************************/
 void MlevelNestedBDFCC(ctrl_t *ctrl, bigraph_t *head, idx_t *order, idx_t ndiags,
-		idx_t *** r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags){
+		bdfdiags_t **r_diags){
+
+	graph_t *graph = head->super, **sgraphs;
+	bigraph_t *bigraph, *tail;
+	idx_t i, j, k, nvtxs, ncmps, ngrps, rnvtxs, nirows, nicols;
+	idx_t *xadj, *label, *cptr, *cind, *gptr, *gind;
+
+	ASSERT(ndiags == 1 && head == ctrl->obigraph);
+
+	WCOREPUSH;
+
+	nvtxs = graph->nvtxs;
+	xadj  = graph->xadj;
+	label = graph->label;
+
+	cptr = iwspacemalloc(ctrl, nvtxs+1);
+	cind = iwspacemalloc(ctrl, nvtxs);
+	ncmps = FindPartitionInducedComponents(graph, NULL, cptr, cind);
+
+	IFSET(ctrl->dbglvl, METIS_DBG_INFO,
+		printf("Number of connected components: %"PRIDX"\n", ncmps));
+
+	if (ncmps == 1) {
+		WCOREPOP;
+		MlevelNestedBDF(ctrl, head, order, ndiags, r_diags);
+		return;
+	}
+
+	/* Regroup the components: the ones with edges are kept as they are, the
+	 * empty rows and the empty columns are gathered into one group each. Such
+	 * a group has no non-zeros and no area, so it does not need to be split */
+	gptr = iwspacemalloc(ctrl, ncmps+3);
+	gind = iwspacemalloc(ctrl, nvtxs);
+	for (nirows = nicols = 0, i = 0; i < ncmps; i++) {
+		if (cptr[i+1] - cptr[i] == 1 && xadj[cind[cptr[i]]+1] == xadj[cind[cptr[i]]]) {
+			if (label[cind[cptr[i]]] < ctrl->nrows)	nirows++;
+			else	nicols++;
+		}
+	}
+	ngrps = 0;
+	gptr[0] = 0;
+	for (k = i = 0; i < ncmps; i++) {
+		if (cptr[i+1] - cptr[i] == 1 && xadj[cind[cptr[i]]+1] == xadj[cind[cptr[i]]])
+			continue;
+		for (j = cptr[i]; j < cptr[i+1]; j++)
+			gind[k++] = cind[j];
+		gptr[++ngrps] = k;
+	}
+	for (j = 0; j < 2; j++) {
+		if ((j == 0 ? nirows : nicols) == 0)	continue;
+		for (i = 0; i < nvtxs; i++) {
+			if (xadj[i+1] == xadj[i] && (label[i] < ctrl->nrows) == (j == 0))
+				gind[k++] = i;
+		}
+		gptr[++ngrps] = k;
+	}
+	ASSERT(k == nvtxs);
+
+	/* SplitGraphOrderCC() splits along a vertex separator, here it is empty */
+	graph->where  = ismalloc(nvtxs, 0, "MlevelNestedBDFCC: where");
+	graph->bndptr = ismalloc(nvtxs, -1, "MlevelNestedBDFCC: bndptr");
+	graph->nbnd   = 0;
+
+	sgraphs = SplitGraphOrderCC(ctrl, graph, ngrps, gptr, gind);
+
+	gk_free((void **)&graph->where, &graph->bndptr, LTERM);
+
+	WCOREPOP;
+
+	/* every component becomes a block diagonal without borders, placed one
+	 * after the other in the final order */
+	head = tail = NULL;
+	ctrl->snz = ctrl->sarea = 0;
+	for (rnvtxs = i = 0; i < ngrps; i++) {
+		bigraph = SetupBiGraphFromComponent(ctrl, sgraphs[i]);
+		if (sgraphs[i]->nedges == 0)
+			bigraph->partible = 0;
+
+		rnvtxs += sgraphs[i]->nvtxs;
+		bigraph->lastvtx = rnvtxs;
+
+		ctrl->snz += bigraph->snz;
+		ctrl->sarea += bigraph->sarea;
+
+		if (tail)	tail->next = bigraph;
+		else	head = bigraph;
+		tail = bigraph;
+	}
+	ASSERT(rnvtxs == nvtxs);
+
+	gk_free((void **)&sgraphs, LTERM);
+
+	MlevelNestedBDF(ctrl, head, order, ngrps, r_diags);
+}
+
+/**
+ * This function sets up a block diagonal without borders from a subgraph
+ * of the original graph, its rows and columns are told apart by the
+ * labels of the vertices.
+ */
+bigraph_t *SetupBiGraphFromComponent(ctrl_t *ctrl, graph_t *graph)
+{
+	idx_t i, nrows, ncols;
+	label_t *rlabel, *clabel;
+
+	for (nrows = i = 0; i < graph->nvtxs; i++) {
+		if (graph->label[i] < ctrl->nrows)	nrows++;
+	}
+	ncols = graph->nvtxs - nrows;
+
+	rlabel = (label_t*)gk_malloc(sizeof(label_t), "SetupBiGraphFromComponent: rlabel");
+	clabel = (label_t*)gk_malloc(sizeof(label_t), "SetupBiGraphFromComponent: clabel");
+	rlabel->label = imalloc(nrows, "SetupBiGraphFromComponent: rlabel->label");
+	clabel->label = imalloc(ncols, "SetupBiGraphFromComponent: clabel->label");
+	rlabel->ref = clabel->ref = 0;
+
+	for (nrows = ncols = i = 0; i < graph->nvtxs; i++) {
+		if (graph->label[i] < ctrl->nrows)	rlabel->label[nrows++] = graph->label[i];
+		else	clabel->label[ncols++] = graph->label[i];
+	}
+
+	return SetupBiGraphFromGraph(graph, nrows, ncols, ctrl->nrows, ctrl->ncols, rlabel, clabel);
+}
+
+/**
+ * This function computes a vertex separator of a block diagonal and
+ * splits its graph into ctrl->kappa subgraphs, some of which may be empty.
+ * With kappa == 2 this is a node bisection, otherwise a k-way separator.
+ * The separator is left in bigraph->super (where, bndind, ...) for the
+ * caller to order. Any partition left by an earlier, rejected bisection
+ * is released first.
+ */
+void BisectBlockDiag(ctrl_t *ctrl, bigraph_t *bigraph, graph_t **sgraphs)
+{
+	graph_t *cgraph, *tosplit;
+	idx_t i, nbnd, *cptr, *cind;
+
+	FreeRData(bigraph->super);
+
+	/* The graph could not be compressed by CompressGraph(), because if an row
+	 * vetex and a column vertex are compressed into one vertex, then this would
+	 * not be a biparatite graph any more !
+	 * CompressBiGraph() only merges rows with rows and columns with columns, it
+	 * is done here before each real partitioning, and the partition result is
+	 * mapped back into orignal indices once finished. */
+	if (ctrl->compress) {
+		cptr = imalloc(bigraph->super->nvtxs+1, "BMETIS: cptr");
+		cind = imalloc(bigraph->super->nvtxs, "BMETIS: cind");
+
+		cgraph = CompressBiGraph(ctrl, bigraph->super, ctrl->nrows, cptr, cind);
+		if (cgraph == NULL) {
+			/* if there was no compression, cleanup the compressed flag */
+			gk_free((void **)&cptr, &cind, LTERM);
+			ctrl->compressed = 0;
+			tosplit = bigraph->super;
+		}
+		else {
+			ctrl->compressed = 1;
+			tosplit = cgraph;
+			/*
+			ctrl->cfactor = 1.0*(*graph->nvtxs)/nnvtxs;
+			if (ctrl->cfactor > 1.5 && ctrl->nseps == 1)	ctrl->nseps = 2;
+			*//* TODO */
+		}
+	}
+	else {
+		ctrl->compressed = 0;
+		tosplit = bigraph->super;
+	}
+
+	ASSERT(CheckGraph(tosplit, ctrl->numflag, 1));	/* TODO debug */
+
+	/* a block too small for k parts is bisected, see MlevelNestedBDF() for
+	 * the blocks whose k-way split was rejected */
+	if (ctrl->kappa > 2 && tosplit->nvtxs < 30*ctrl->kappa)
+		bigraph->bisect = 1;
+
+	if (ctrl->kappa == 2)
+		MlevelNodeBisectionMultipleBDF(ctrl, tosplit);
+	else if (bigraph->bisect)
+		MlevelKWayNodeSeparatorBDF(ctrl, tosplit, 2, (ctrl->seed == -1 ? 4321 : ctrl->seed) + bigraph->lastvtx);
+	else
+		SelectKWayNodeSeparatorBDF(ctrl, bigraph, tosplit, (ctrl->compressed ? cptr : NULL), cind,
+				(ctrl->seed == -1 ? 4321 : ctrl->seed) + bigraph->lastvtx);
+
+	/* extract resulting blocks diagonal list, note that compression may have been done */
+	if (ctrl->compressed) {
+		SplitGraphOrderUncompressBDF(ctrl, bigraph->super, cgraph, cptr, cind, sgraphs);
+		FreeGraph(&cgraph);
+		gk_free((void **)&cptr, &cind, LTERM);
+	}
+	else {
+		SplitGraphOrderBDF(ctrl, bigraph->super, sgraphs);
+	}
+
+	/* list the separator in vertex order, as SplitCachedBisection() does, so that
+	 * the ordering does not depend on whether the bisection was cached */
+	if (bigraph->super->where != NULL) {
+		for (nbnd = 0, i = 0; i < bigraph->super->nvtxs; i++) {
+			if (bigraph->super->where[i] == ctrl->kappa)
+				bigraph->super->bndind[nbnd++] = i;
+		}
+	}
+}
+
+/**
+ * This function computes a k-way vertex separator of graph, k = nparts,
+ * from a single multilevel k-way edge partitioning, see
+ * KWayEdgePartitionBDF() and CoverCutEdgesBDF(). On return where[] holds
+ * the parts 0..nparts-1 and ctrl->kappa for the separator, as set up by
+ * SetupSeparatorFromWhere(). With nparts == 2, or a graph too small for
+ * k parts, graph is bisected.
+ */
+void MlevelKWayNodeSeparatorBDF(ctrl_t *ctrl, graph_t *graph, idx_t nparts, idx_t seed)
+{
+	idx_t i, nvtxs;
+	idx_t *where;
+
+	nvtxs = graph->nvtxs;
+
+	if (nparts == 2 || nvtxs < 30*nparts) {
+		MlevelNodeBisectionMultipleBDF(ctrl, graph);
+
+		where = icopy(nvtxs, graph->where, imalloc(nvtxs, "MlevelKWayNodeSeparatorBDF: where"));
+		FreeRData(graph);
+		for (i = 0; i < nvtxs; i++) {
+			if (where[i] == 2)
+				where[i] = ctrl->kappa;
+		}
+
+		graph->where = where;
+		SetupSeparatorFromWhere(ctrl, graph);
+		return;
+	}
+
+	where = imalloc(nvtxs, "MlevelKWayNodeSeparatorBDF: where");
+	KWayEdgePartitionBDF(ctrl, graph, nparts, seed, where);
+	CoverCutEdgesBDF(ctrl, graph, where, ctrl->kappa);
+
+	FreeRData(graph);
+	graph->where = where;
+	SetupSeparatorFromWhere(ctrl, graph);
+}
+
+/**
+ * This function computes a multilevel k-way edge partitioning of graph
+ * into nparts parts, and stores it in where[].
+ */
+void KWayEdgePartitionBDF(ctrl_t *ctrl, graph_t *graph, idx_t nparts, idx_t seed, idx_t *where)
+{
+	idx_t nvtxs, options[METIS_NOPTIONS];
+	ctrl_t *kctrl;
+	graph_t *kgraph;
+
+	nvtxs = graph->nvtxs;
+
+	/* k-way partitioning on a graph sharing the arrays of graph, as
+	 * MlevelKWayPartitioning() frees the graph it is given */
+	METIS_SetDefaultOptions(options);
+	options[METIS_OPTION_CTYPE] = ctrl->ctype;
+	options[METIS_OPTION_NITER] = ctrl->niter;
+	options[METIS_OPTION_SEED]  = seed;
+
+	kctrl = SetupCtrl(METIS_OP_KMETIS, options, 1, nparts, NULL, NULL);
+	kctrl->nthreads = ctrl->nthreads;	/* for METIS_CTYPE_PHEM */
+	kgraph = SetupGraph(kctrl, nvtxs, 1, graph->xadj, graph->adjncy, graph->vwgt, NULL, graph->adjwgt);
+
+	SetupKWayBalMultipliers(kctrl, kgraph);
+	kctrl->CoarsenTo = gk_max(nvtxs/(20*gk_log2(nparts)), 30*nparts);
+	/* fewer initial partitionings than kmetis does, a k-way split is only
+	 * worth it if it costs about what the bisection it replaces does */
+	kctrl->nIparts   = 2;
+
+	AllocateWorkSpace(kctrl, kgraph);
+	MlevelKWayPartitioning(kctrl, kgraph, where);
+
+	FreeCtrl(&kctrl);
+}
+
+/**
+ * This function turns the parts in where[] into a vertex separator. As the
+ * graph is bipartite, the cut edges form a bipartite graph between rows
+ * and columns, and its minimum vertex cover is taken as the separator,
+ * whose vertices get sep in where[].
+ */
+void CoverCutEdgesBDF(ctrl_t *ctrl, graph_t *graph, idx_t *where, idx_t sep)
+{
+	idx_t i, ii, j, jj, l, nvtxs, nbnd, side, csize;
+	idx_t bnvtxs[2];
+	idx_t *xadj, *adjncy, *label, *vmap, *ivmap, *bxadj, *badjncy, *cover;
+
+	nvtxs  = graph->nvtxs;
+	xadj   = graph->xadj;
+	adjncy = graph->adjncy;
+	label  = graph->label;
+
+	WCOREPUSH;
+
+	/* the rows and the columns with cut edges, numbered from 0 on, rows first */
+	vmap  = iwspacemalloc(ctrl, nvtxs);
+	ivmap = iwspacemalloc(ctrl, nvtxs);
+	bxadj = iwspacemalloc(ctrl, nvtxs+1);
+
+	bnvtxs[0] = bnvtxs[1] = nbnd = 0;
+	for (i = 0; i < nvtxs; i++) {
+		vmap[i] = -1;
+		for (j = xadj[i]; j < xadj[i+1]; j++) {
+			if (where[adjncy[j]] != where[i]) {
+				bnvtxs[label[i] < ctrl->nrows ? 0 : 1]++;
+				vmap[i] = 0;
+				break;
+			}
+		}
+	}
+	bnvtxs[1] = bnvtxs[0];
+	bnvtxs[0] = 0;
+	for (i = 0; i < nvtxs; i++) {
+		if (vmap[i] == 0) {
+			side = (label[i] < ctrl->nrows ? 0 : 1);
+			vmap[i] = bnvtxs[side];
+			ivmap[bnvtxs[side]++] = i;
+		}
+	}
+	nbnd = bnvtxs[1];
+
+	if (nbnd > 0) {
+		for (l = 0, ii = 0; ii < nbnd; ii++) {
+			i = ivmap[ii];
+			for (j = xadj[i]; j < xadj[i+1]; j++) {
+				if (where[adjncy[j]] != where[i])
+					l++;
+			}
+		}
+		badjncy = iwspacemalloc(ctrl, l+1);
+		cover   = iwspacemalloc(ctrl, nbnd);
+
+		bxadj[0] = l = 0;
+		for (ii = 0; ii < nbnd; ii++) {
+			i = ivmap[ii];
+			for (j = xadj[i]; j < xadj[i+1]; j++) {
+				jj = adjncy[j];
+				if (where[jj] != where[i])
+					badjncy[l++] = vmap[jj];
+			}
+			bxadj[ii+1] = l;
+		}
+
+		MinCover(bxadj, badjncy, bnvtxs[0], bnvtxs[1], cover, &csize);
+
+		IFSET(ctrl->dbglvl, METIS_DBG_SEPINFO,
+			printf("Nvtxs: %6"PRIDX", SS: [%6"PRIDX" %6"PRIDX"], Cover: %6"PRIDX"\n",
+				nvtxs, bnvtxs[0], bnvtxs[1]-bnvtxs[0], csize));
+
+		for (i = 0; i < csize; i++)
+			where[ivmap[cover[i]]] = sep;
+	}
+
+	WCOREPOP;
+}
+
+/**
+ * This function computes a k-way separator of graph, k = ctrl->kappa,
+ * the graph of bigraph or its compressed graph (cptr/cind, NULL if not
+ * compressed), and a bisection from the same k-way edge partitioning: its
+ * first kappa/2 parts and its other parts are the two sides, the cover of
+ * the edges between them is the separator, which is then refined as on
+ * the finest level of a node bisection. So the graph is partitioned once.
+ * The k-way split is kept only if its density gain per new block beats
+ * the density gain of the bisection: it spends k-1 blocks of the block
+ * budget where a bisection spends one, and all its blocks share its
+ * separator as a border. The gains are those of the blocks themselves (see
+ * SeparatorNzAndArea), so the choice does not depend on when the block is
+ * split. Otherwise the bisection is left in graph, and if MlevelNestedBDF()
+ * rejects it, the block gets a multilevel bisection the next time.
+ */
+void SelectKWayNodeSeparatorBDF(ctrl_t *ctrl, bigraph_t *bigraph, graph_t *graph,
+		idx_t *cptr, idx_t *cind, idx_t seed)
+{
+	idx_t i, j, k, nvtxs, nparts[2], nsnz[2], nsarea[2];
+	idx_t *bwhere, *kwhere, *where;
+	idx_t **rwgts, **inzs;
+	real_t density, gains[2];
+
+	nvtxs = graph->nvtxs;
+
+	bwhere = imalloc(nvtxs, "SelectKWayNodeSeparatorBDF: bwhere");
+	kwhere = imalloc(nvtxs, "SelectKWayNodeSeparatorBDF: kwhere");
+
+	KWayEdgePartitionBDF(ctrl, graph, ctrl->kappa, seed, kwhere);
+	for (i = 0; i < nvtxs; i++)
+		bwhere[i] = (kwhere[i] < ctrl->kappa/2 ? 0 : 1);
+	CoverCutEdgesBDF(ctrl, graph, kwhere, ctrl->kappa);
+	CoverCutEdgesBDF(ctrl, graph, bwhere, 2);
+
+	/* refine the bisection, as Refine2WayNode() does on the finest level */
+	FreeRData(graph);
+	Allocate2WayNodePartitionMemory(ctrl, graph);
+	icopy(nvtxs, bwhere, graph->where);
+	Compute2WayNodePartitionParams(ctrl, graph);
+	FM_2WayNodeBalance(ctrl, graph);
+	if (ctrl->rtype == METIS_RTYPE_SEP2SIDED) {
+		FM_2WayNodeRefine2Sided(ctrl, graph, ctrl->niter);
+	}
+	else if (ctrl->rtype == METIS_RTYPE_SEPDENSE && !ctrl->compressed) {
+		Setup2WayNodeDensityInfo(ctrl, graph, graph, &rwgts, &inzs);
+		FM_2WayNodeRefineDensity(ctrl, graph, ctrl->niter, rwgts[0], inzs[0]);
+		gk_free((void **)&rwgts[0], &inzs[0], &rwgts, &inzs, LTERM);
+	}
+	else {
+		FM_2WayNodeRefine1Sided(ctrl, graph, ctrl->niter);
+	}
+	for (i = 0; i < nvtxs; i++)
+		bwhere[i] = (graph->where[i] == 2 ? ctrl->kappa : graph->where[i]);
+	FreeRData(graph);
+
+	/* score both separators on the vertices of bigraph */
+	where = (cptr == NULL ? NULL : imalloc(bigraph->super->nvtxs, "SelectKWayNodeSeparatorBDF: where"));
+	density = 1.0 * bigraph->snz / bigraph->sarea;
+	for (i = 0; i < 2; i++) {
+		if (cptr != NULL) {
+			for (j = 0; j < nvtxs; j++) {
+				for (k = cptr[j]; k < cptr[j+1]; k++)
+					where[cind[k]] = (i == 0 ? kwhere[j] : bwhere[j]);
+			}
+		}
+		nparts[i] = SeparatorNzAndArea(ctrl, bigraph, (cptr == NULL ? (i == 0 ? kwhere : bwhere) : where),
+				&nsnz[i], &nsarea[i]);
+		gains[i] = 1.0 * nsnz[i] / nsarea[i] - density;
+	}
+
+	IFSET(ctrl->dbglvl, METIS_DBG_SEPINFO,
+		printf("Nvtxs: %6"PRIDX", %"PRIDX"-way gain: %.6e, 2-way gain: %.6e\n",
+			nvtxs, nparts[0], gains[0], gains[1]));
+
+	if (nparts[0] > nparts[1] && gains[0] > (nparts[0]-1) * gains[1]) {
+		graph->where = kwhere;
+		gk_free((void **)&bwhere, LTERM);
+	}
+	else {
+		graph->where = bwhere;
+		gk_free((void **)&kwhere, LTERM);
+	}
+	SetupSeparatorFromWhere(ctrl, graph);
+
+	gk_free((void **)&where, LTERM);
+}
+
+/**
+ * This function computes the non-zeros and the area (borders included) of
+ * the blocks a separator of bigraph gives, as ExtractBiGraph() would build
+ * them: where[] holds the parts of the vertices of bigraph->super, with
+ * ctrl->kappa for the separator. Every block has the separator and the
+ * borders of bigraph as its borders. A vertex's non-zeros to the borders
+ * are its edges in ctrl->obigraph that bigraph does not have. It needs the
+ * borders of bigraph in ctrl, see SetupDensityBorders(), and returns the
+ * number of non-empty parts.
+ */
+idx_t SeparatorNzAndArea(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *where,
+		idx_t *r_nsnz, idx_t *r_nsarea)
+{
+	idx_t i, j, s, sep, nvtxs, nparts, snz, ssnz;
+	idx_t *xadj, *adjncy, *adjwgt, *label, *oxadj, *rows, *cols;
+	graph_t *graph = bigraph->super;
+
+	nvtxs  = graph->nvtxs;
+	xadj   = graph->xadj;
+	adjncy = graph->adjncy;
+	adjwgt = graph->adjwgt;
+	label  = graph->label;
+	oxadj  = ctrl->obigraph->super->xadj;
+	sep    = ctrl->kappa;
+
+	WCOREPUSH;
+
+	rows = iset(sep+1, 0, iwspacemalloc(ctrl, sep+1));
+	cols = iset(sep+1, 0, iwspacemalloc(ctrl, sep+1));
+
+	/* snz counts the non-zeros in one block, ssnz those in every block */
+	for (snz = ssnz = 0, i = 0; i < nvtxs; i++) {
+		if (label[i] < ctrl->nrows)	rows[where[i]]++;
+		else	cols[where[i]]++;
+
+		if (where[i] == sep) {
+			ssnz += (oxadj[label[i]+1] - oxadj[label[i]]) - (xadj[i+1] - xadj[i]);
+			for (j = xadj[i]; j < xadj[i+1]; j++) {
+				if (where[adjncy[j]] == sep && adjncy[j] > i)
+					ssnz += adjwgt[j];
+			}
+		}
+		else {
+			snz += (oxadj[label[i]+1] - oxadj[label[i]]) - (xadj[i+1] - xadj[i]);
+			for (j = xadj[i]; j < xadj[i+1]; j++) {
+				if (where[adjncy[j]] == sep || adjncy[j] > i)
+					snz += adjwgt[j];
+			}
+		}
+	}
+
+	*r_nsarea = 0;
+	for (nparts = 0, s = 0; s < sep; s++) {
+		if (rows[s] + cols[s] == 0)
+			continue;
+		nparts++;
+		*r_nsarea += (rows[s] + rows[sep] + ctrl->dbrows) * (cols[s] + cols[sep] + ctrl->dbcols);
+	}
+	*r_nsnz = snz + nparts * (ssnz + ctrl->dbnz/2);
+
+	WCOREPOP;
+
+	return nparts;
+}
+
+/**
+ * This function rebuilds the subgraphs of a block diagonal from the
+ * separator cached in bigraph->cwhere by a rejected bisection, without
+ * coarsening and refining again. The separator is left in bigraph->super
+ * (where, bndind, ...) as BisectBlockDiag() does.
+ */
+void SplitCachedBisection(ctrl_t *ctrl, bigraph_t *bigraph, graph_t **sgraphs)
+{
+	graph_t *graph = bigraph->super;
+
+	FreeRData(graph);
+
+	graph->where = bigraph->cwhere;
+	bigraph->cwhere = NULL;
+
+	SetupSeparatorFromWhere(ctrl, graph);
+
+	SplitGraphOrderBDF(ctrl, graph, sgraphs);
+}
+
+/**
+ * This function keeps a rejected bisection of bigraph in cwhere/csnz/csarea/carea
+ * and releases the nparts blocks it produced. A bisection that was already
+ * cached (children[0] == NULL) is left as it is.
+ */
+void CacheBisection(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, bigraph_t **children,
+		idx_t nsnz, idx_t nsarea, idx_t narea)
+{
+	idx_t s;
+
+	if (children[0] == NULL)
+		return;
+
+	/* keep the separator and the subtotals of the blocks, then
+	 * release memory of the blocks */
+	bigraph->cwhere = bigraph->super->where;
+	bigraph->super->where = NULL;
+	FreeRData(bigraph->super);
+	bigraph->csnz = nsnz;
+	bigraph->csarea = nsarea;
+	bigraph->carea = narea;
+
+	for (s = 0; s < nparts; s++)
+		FreeBiGraph(ctrl, &children[s]);
+	children[0] = NULL;
+}
+
+/**
+ * This function sets up pwgts, mincut and the boundary (bndptr, bndind)
+ * of a vertex separator given by graph->where, which is all that
+ * SplitGraphOrderBDF() needs. The separator is part ctrl->kappa.
+ */
+void SetupSeparatorFromWhere(ctrl_t *ctrl, graph_t *graph)
+{
+	idx_t i, nvtxs, nbnd;
+	idx_t *vwgt, *where, *pwgts, *bndptr, *bndind;
+
+	nvtxs = graph->nvtxs;
+	vwgt  = graph->vwgt;
+	where = graph->where;
+
+	pwgts  = graph->pwgts  = ismalloc(ctrl->kappa+1, 0, "SetupSeparatorFromWhere: pwgts");
+	bndptr = graph->bndptr = ismalloc(nvtxs, -1, "SetupSeparatorFromWhere: bndptr");
+	bndind = graph->bndind = imalloc(nvtxs, "SetupSeparatorFromWhere: bndind");
+
+	for (nbnd = 0, i = 0; i < nvtxs; i++) {
+		pwgts[where[i]] += vwgt[i];
+		if (where[i] == ctrl->kappa)
+			BNDInsert(nbnd, bndind, bndptr, i);
+	}
+	graph->mincut = pwgts[ctrl->kappa];
+	graph->nbnd   = nbnd;
+}
+
+/**
+ * This function drops the empty graphs among graphs[0..n-1], keeping the
+ * order of the others, and returns how many are left.
+ */
+idx_t RemoveEmptyGraphs(idx_t n, graph_t **graphs)
+{
+	idx_t i, m;
+
+	for (m = i = 0; i < n; i++) {
+		if (graphs[i]->nvtxs == 0)
+			FreeGraph(&graphs[i]);
+		else
+			graphs[m++] = graphs[i];
+	}
 
+	return m;
+}
+
+/**
+ * This function bisects the candidate block diagonals in cands[] that have
+ * no cached bisection (cwhere) concurrently, one candidate per OpenMP thread.
+ * Each thread works on a private ctrl (SetupWorkerCtrl) and its own gk_malloc
+ * tracking core, which is handed back to the calling thread once the
+ * bisection is done. As in the serial case, the random generator is reseeded
+ * from the seed and the position (lastvtx) of the candidate, so the separators
+ * do not depend on the number of threads nor on the scheduling.
+ * The subgraphs of the i-th candidate without a cached bisection are returned
+ * in sgraphs[i*kappa..(i+1)*kappa-1].
+ */
+void BisectBlockDiagsP(ctrl_t *ctrl, idx_t ncands, bigraph_t **cands, graph_t **sgraphs)
+{
+	idx_t i, j, seed;
+	idx_t *slots;
+	gk_mcore_t **mcores;
+	chier_t **chiers;
+
+	mcores = (gk_mcore_t **)gk_malloc(ncands * sizeof(gk_mcore_t *), "BisectBlockDiagsP: mcores");
+
+	/* a bisection replaces the coarsening hierarchy of the candidate, which
+	 * belongs to this thread, so the workers coarsen with their own copies */
+	chiers = (chier_t **)gk_malloc(ncands * sizeof(chier_t *), "BisectBlockDiagsP: chiers");
+	slots  = imalloc(ncands, "BisectBlockDiagsP: slots");
+	for (i = 0, j = 0; j < ncands; j++) {
+		chiers[j] = NULL;
+		if (cands[j]->cwhere == NULL) {
+			chiers[j] = cands[j]->super->chier;
+			cands[j]->super->chier = NULL;
+			slots[j] = i++;
+		}
+	}
+
+	seed = (ctrl->seed == -1 ? 4321 : ctrl->seed);
+
+	#pragma omp parallel for num_threads(ctrl->nthreads) schedule(dynamic, 1)
+	for (j = 0; j < ncands; j++) {
+		ctrl_t *wctrl;
+		gk_mcore_t *omcore;
+
+		mcores[j] = NULL;
+		if (cands[j]->cwhere != NULL)	continue;
+
+		omcore = gk_malloc_detach();
+		gk_malloc_init();
+
+		wctrl = SetupWorkerCtrl(ctrl, cands[j]->super);
+		InitRandom(seed + cands[j]->lastvtx);
+		SetupDensityBorders(ctrl, cands[j], wctrl);
+		cands[j]->super->chier = CopyCHier(chiers[j]);
+
+		BisectBlockDiag(wctrl, cands[j], sgraphs + slots[j]*ctrl->kappa);
+
+		FreeWorkerCtrl(&wctrl);
+
+		mcores[j] = gk_malloc_detach();
+		gk_malloc_attach(omcore);
+	}
+
+	for (j = 0; j < ncands; j++) {
+		gk_malloc_adopt(mcores[j]);
+		FreeCHier(&chiers[j]);
+	}
+
+	gk_free((void **)&mcores, &chiers, &slots, LTERM);
+}
+
+/**
+ * This function sets up in bctrl what METIS_RTYPE_SEPDENSE needs to know
+ * about the borders of bigraph: the non-zeros among them, which both halves
+ * of a bisection inherit (see ExtractBiGraph), and their numbers of rows
+ * and columns. The borders are read from ctrl, as a worker ctrl has none.
+ */
+void SetupDensityBorders(ctrl_t *ctrl, bigraph_t *bigraph, ctrl_t *bctrl) {
+	idx_t t, u, nb, nrows, ncols;
+
+	StatNrowsAndNcols(ctrl, bigraph, &nrows, &ncols);
+
+	nb = bigraph->nbrds;
+	bctrl->dbnz = 0;
+	if (bigraph->bnz != NULL) {
+		for (t = 1; t <= nb; t++)
+			for (u = 1; u <= nb; u++)
+				bctrl->dbnz += 2*bigraph->bnz[t*(nb+1)+u];
+	}
+	bctrl->dbrows = nrows - bigraph->nrows;
+	bctrl->dbcols = ncols - bigraph->ncols;
 }
 
 /**
@@ -330,139 +1132,132 @@ void OrderEachGraph(bigraph_t *head, idx_t *order) {
 	}
 }
 
-void ConstructResult(bigraph_t *head, idx_t ndiags, idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags) {
-	idx_t **rdiags, **cdiags;
-	bigraph_t *p, *q;
-	idx_t i, j, k, nrows, ncols, snrows, sncols;
+/**
+ * This function packs the rows and columns of the block diagonals in the
+ * list into a bdfdiags_t. The structure and its four arrays are allocated
+ * at once, see metis.h.
+ */
+bdfdiags_t *ConstructResult(ctrl_t *ctrl, bigraph_t *head, idx_t ndiags) {
+	bdfdiags_t *diags;
+	bigraph_t *p;
+	border_t *border;
+	idx_t i, j, k, t, nrows, ncols, nrind, ncind;
+	idx_t *rptr, *cptr, *rind, *cind;
 
 	idx_t sarea = 0, snz = 0, area, nz, cnt = 0;
 	real_t dense;
+	bdfstats_t *stats = ctrl->stats;
+
+	/* the sizes of all blocks go to wspace first, they are needed for the allocation */
+	WCOREPUSH;
+	rptr = iwspacemalloc(ctrl, ndiags+1);
+	cptr = iwspacemalloc(ctrl, ndiags+1);
+	rptr[0] = cptr[0] = 0;
+	for (i = 0, p = head; p; p = p->next, i++) {
+		StatNrowsAndNcols(ctrl, p, &nrows, &ncols);
+		rptr[i+1] = rptr[i] + nrows;
+		cptr[i+1] = cptr[i] + ncols;
+	}
+	ASSERT(i == ndiags);
+	nrind = rptr[ndiags];
+	ncind = cptr[ndiags];
 
 	/* used malloc instead of gk_malloc, becasue gk_malloced memory will be released
 	 * in gkmalloc_clean_up in METIS_NodeBDF, but we stil nedd the memory in rbbdf.c */
-	rdiags = (idx_t**)malloc(ndiags * sizeof(idx_t*));
-	cdiags = (idx_t**)malloc(ndiags * sizeof(idx_t*));
-
-	i = 0;
-	p = head;
-	while (p) {
-		nrows = 0;	q = p;
-		while (q) {
-			nrows += q->nrows;
-			q = q->down;
-		}
-
-		ncols = 0;	q = p;
-		while (q) {
-			ncols += q->ncols;
-			q = q->right;
-		}
-
-		rdiags[i] = (idx_t*)malloc((nrows + 1) * sizeof(idx_t));
-		cdiags[i] = (idx_t*)malloc((ncols + 1) * sizeof(idx_t));
-		rdiags[i][0] = nrows;
-		cdiags[i][0] = ncols;
-
-		j = 1;	q = p;
-		while (q) {
-			for (k = 0; k < q->nrows; k++)	rdiags[i][j++] = q->rlabel->label[k];
-			q = q->down;
-		}
+	diags = (bdfdiags_t*)malloc(sizeof(bdfdiags_t) + (2*(ndiags+1) + nrind + ncind) * sizeof(idx_t));
+	if (diags == NULL)
+		gk_errexit(SIGMEM, "***Memory allocation failed for ConstructResult: diags.\n");
+
+	diags->ndiags = ndiags;
+	diags->nrind  = nrind;
+	diags->ncind  = ncind;
+	diags->rptr   = (idx_t*)(diags + 1);
+	diags->cptr   = diags->rptr + ndiags + 1;
+	diags->rind   = diags->cptr + ndiags + 1;
+	diags->cind   = diags->rind + nrind;
+	icopy(ndiags+1, rptr, diags->rptr);
+	icopy(ndiags+1, cptr, diags->cptr);
+	WCOREPOP;
 
-		j = 1;	q = p;
-		while (q) {
-			for (k = 0; k < q->ncols; k++)	cdiags[i][j++] = q->clabel->label[k];
-			q = q->right;
+	rptr = diags->rptr;
+	cptr = diags->cptr;
+	rind = diags->rind;
+	cind = diags->cind;
+	for (i = 0, p = head; p; p = p->next, i++) {
+		/* the block itself, then its border groups from the latest one on */
+		icopy(p->nrows, p->rlabel->label, rind+rptr[i]);
+		icopy(p->ncols, p->clabel->label, cind+cptr[i]);
+		for (j = rptr[i]+p->nrows, k = cptr[i]+p->ncols, t = 0; t < p->nbrds; t++) {
+			border = ctrl->borders + p->brds[t];
+			icopy(border->nrows, border->rlabel, rind+j);
+			icopy(border->ncols, border->clabel, cind+k);
+			j += border->nrows;
+			k += border->ncols;
 		}
-
-		p = p->next;
-		i++;
+		ASSERT(j == rptr[i+1] && k == cptr[i+1]);
 	}
 
-	*r_ndiags = ndiags;
-	*r_rdiags = rdiags;
-	*r_cdiags = cdiags;
-
 	/* Some statistics */
 	p = head;
-	i = cnt = snrows = sncols = 0;
 	while (p) {
 		cnt++;
-		StatNzAndArea(p, &nz, &area, 0);
+		nz = p->snz;
+		area = p->sarea;
 		sarea += area;
 		snz += nz;
 		dense = 1.0 * nz / area;
 
-		if (area > _maxarea)	_maxarea = area;
-		if (nz > _maxnz)	_maxnz = nz;
-		if (area < _minarea)	_minarea = area;
-		if (nz < _minnz)	_minnz = nz;
-		if (dense > _maxdense)	_maxdense = dense;
-		if (dense < _mindense)	_mindense = dense;
+		if (area > stats->maxarea)	stats->maxarea = area;
+		if (nz > stats->maxnz)	stats->maxnz = nz;
+		if (area < stats->minarea)	stats->minarea = area;
+		if (nz < stats->minnz)	stats->minnz = nz;
+		if (dense > stats->maxdense)	stats->maxdense = dense;
+		if (dense < stats->mindense)	stats->mindense = dense;
 
-		StatNrowsAndNcols(p, &nrows, &ncols);
-		snrows += nrows;
-		sncols += ncols;
 		p = p->next;
 	}
 
-	printf("Average nrows = %.2f, Average ncols = %.2f\n", 1.0*snrows/cnt, 1.0*sncols/cnt);
+	printf("Average nrows = %.2f, Average ncols = %.2f\n", 1.0*nrind/cnt, 1.0*ncind/cnt);
 
-	_avgarea = 1.0 * sarea / cnt;
-	_avgnz = 1.0 * snz / cnt;
+	stats->avgarea = 1.0 * sarea / cnt;
+	stats->avgnz = 1.0 * snz / cnt;
+
+	return diags;
 }
 
 /**
  * This function calculates the total area and non-zeros of a graph.
  * It DOES take borders into account.
  */
-void StatNzAndArea(bigraph_t *bigraph, idx_t *r_snz, idx_t *r_sarea, idx_t islist) {
-	bigraph_t *pblock, *prow, *pcolumn;
-	idx_t snz = 0, sarea = 0;
-	idx_t nrblocks = 0, cnt = 0;
+void StatNzAndArea(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *r_snz, idx_t *r_sarea, idx_t islist) {
+	bigraph_t *pblock;
+	idx_t i, nrows, ncols, snz = 0, sarea = 0;
 
-	pblock = bigraph;
-	while(pblock){
-		cnt = 0;
-		nrblocks = 0;
-		prow = pblock;
-		while(prow){
-			nrblocks++;
-			pcolumn = prow;
-			while(pcolumn){
-				cnt++;
-				snz += pcolumn->nz;
-				sarea += pcolumn->area;
-				pcolumn = pcolumn->right;
-			}
-			prow = prow->down;
-		}
-		if (! islist)	break;
-		pblock = pblock->next;
+	for (pblock = bigraph; pblock; pblock = pblock->next) {
+		StatNrowsAndNcols(ctrl, pblock, &nrows, &ncols);
+		sarea += nrows * ncols;
 
-		if (cnt != nrblocks * nrblocks) {	/* TODO debug */
-			printf("***ERROR: # blocks is not a square number !\n"); exit(-1);
+		if (pblock->bnz == NULL)	snz += pblock->nz;
+		else {
+			for (i = 0; i < (pblock->nbrds+1)*(pblock->nbrds+1); i++)
+				snz += pblock->bnz[i];
 		}
+
+		if (! islist)	break;
 	}
 
 	*r_snz = snz;
 	*r_sarea = sarea;
 }
 
-void StatNrowsAndNcols(bigraph_t *bigraph, idx_t *r_nrows, idx_t *r_ncols) {
-	idx_t nrows = 0, ncols = 0;
-	bigraph_t *p;
+void StatNrowsAndNcols(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *r_nrows, idx_t *r_ncols) {
+	idx_t t, nrows, ncols;
 
-	p = bigraph;
-	while (p) {
-		nrows += p->nrows;
-		p = p->down;
-	}
-
-	p = bigraph;
-	while (p) {
-		ncols += p->ncols;
-		p = p->right;
+	nrows = bigraph->nrows;
+	ncols = bigraph->ncols;
+	for (t = 0; t < bigraph->nbrds; t++) {
+		nrows += ctrl->borders[bigraph->brds[t]].nrows;
+		ncols += ctrl->borders[bigraph->brds[t]].ncols;
 	}
 
 	*r_nrows = nrows;
@@ -472,31 +1267,23 @@ void StatNrowsAndNcols(bigraph_t *bigraph, idx_t *r_nrows, idx_t *r_ncols) {
 /**
  * This functions computes the average density of block diagonals.
  * Note that it DOES take borders into account.
+ * The running totals in ctrl are kept up to date by MlevelNestedBDF,
+ * so the block list does not need to be scanned.
  */
-real_t AverageDensity(bigraph_t *head) {
-	idx_t snz = 0, sarea = 0;
-	StatNzAndArea(head, &snz, &sarea, 1);
-	return 1.0 * snz / sarea;
+real_t AverageDensity(ctrl_t *ctrl) {
+	return 1.0 * ctrl->snz / ctrl->sarea;
 }
 
 /**
  * This function calculates the new average denstiy if we replace bigraph old with
- * new bigraphs new1 and new2.
+ * two new bigraphs whose subtotals sum up to nsnz and nsarea. It only uses the
+ * subtotals and the running totals in ctrl, thus it takes O(1) time.
  */
-real_t AverageReplaceDensity(bigraph_t *head, bigraph_t *old, bigraph_t *new1, bigraph_t *new2) {
-	idx_t snz = 0, sarea = 0, nz = 0, area = 0;
-
-	StatNzAndArea(head, &nz, &area, 1);
-	snz += nz;	sarea += area;
+real_t AverageReplaceDensity(ctrl_t *ctrl, bigraph_t *old, idx_t nsnz, idx_t nsarea) {
+	idx_t snz, sarea;
 
-	StatNzAndArea(old, &nz, &area, 0);
-	snz -= nz;	sarea -= area;
-
-	StatNzAndArea(new1, &nz, &area, 0);
-	snz += nz;	sarea += area;
-
-	StatNzAndArea(new2, &nz, &area, 0);
-	snz += nz;	sarea += area;
+	snz = ctrl->snz - old->snz + nsnz;
+	sarea = ctrl->sarea - old->sarea + nsarea;
 
 	return 1.0 * snz / sarea;
 }
@@ -507,10 +1294,7 @@ real_t AverageReplaceDensity(bigraph_t *head, bigraph_t *old, bigraph_t *new1, b
  */
 real_t Density(bigraph_t *bigraph)
 {
-	idx_t snz = 0, sarea = 0;
-	StatNzAndArea(bigraph, &snz, &sarea, 0);
-
-	return 1.0 * snz / sarea;
+	return 1.0 * bigraph->snz / bigraph->sarea;
 //	return 1.0 * bigraph->nz / bigraph->area;
 }
 
@@ -520,20 +1304,7 @@ real_t Density(bigraph_t *bigraph)
  */
 idx_t Area(bigraph_t *bigraph)
 {
-	bigraph_t *p, *q;
-	idx_t sarea;
-
-	sarea = 0;	p = bigraph;
-	while (p) {
-		q = p;
-		while (q) {
-			sarea += q->area;
-			q = q->right;
-		}
-		p = p->down;
-	}
-
-	return sarea;
+	return bigraph->sarea;
 }
 
 /*
@@ -667,47 +1438,71 @@ void QSortBlockDiagsByArea(bigraph_t** sort, idx_t *areas, idx_t l, idx_t r) {
     }
 }
 
+/* heap order of the block queue: the larger area first, then the smaller id */
+#define BLOCK_ABOVE(a, b) ((a).key > (b).key || ((a).key == (b).key && (a).val < (b).val))
+
+/*
+ * This function inserts block diagonal id with the given area into the
+ * max-heap heap[0..*r_nnodes). The blocks are ordered by area and then by
+ * id, so blocks of equal area come out in the same order whatever the
+ * history of the heap is.
+ */
+void BlockQueueInsert(ikv_t *heap, idx_t *r_nnodes, idx_t id, idx_t area) {
+	idx_t i, j;
+	ikv_t node;
+
+	node.key = area;
+	node.val = id;
+
+	for (i = (*r_nnodes)++; i > 0; i = j) {
+		j = (i-1) >> 1;
+		if (!BLOCK_ABOVE(node, heap[j]))
+			break;
+		heap[i] = heap[j];
+	}
+	heap[i] = node;
+}
+
+/*
+ * This function removes the top block diagonal of the max-heap
+ * heap[0..*r_nnodes) and returns its id, or -1 if the heap is empty.
+ */
+idx_t BlockQueueGetTop(ikv_t *heap, idx_t *r_nnodes) {
+	idx_t i, j, nnodes, id;
+	ikv_t node;
+
+	if (*r_nnodes == 0)
+		return -1;
+
+	id = heap[0].val;
+	nnodes = --(*r_nnodes);
+	node = heap[nnodes];
+
+	for (i = 0; (j = 2*i+1) < nnodes; i = j) {
+		if (j+1 < nnodes && BLOCK_ABOVE(heap[j+1], heap[j]))
+			j++;
+		if (!BLOCK_ABOVE(heap[j], node))
+			break;
+		heap[i] = heap[j];
+	}
+	heap[i] = node;
+
+	return id;
+}
+
 /*************************************************************************/
 /*! This function performs multilevel node bisection (i.e., tri-section).
     It performs multiple bisections and selects the best. */
 /*************************************************************************/
 void MlevelNodeBisectionMultipleBDF(ctrl_t *ctrl, graph_t *graph)
 {
-	idx_t i, mincut;
-	idx_t *bestwhere;
-
 	/* if the graph is small, just find a single vertex separator */
 	if (ctrl->nseps == 1 || graph->nvtxs < (ctrl->compress ? 1000 : 2000)) {
 		MlevelNodeBisectionBDFL2(ctrl, graph, LARGENIPARTS);
 		return;
 	}
 
-	WCOREPUSH;
-
-	bestwhere = iwspacemalloc(ctrl, graph->nvtxs);
-
-	mincut = graph->tvwgt[0];
-	for (i=0; i<ctrl->nseps; i++) {
-		MlevelNodeBisectionBDFL2(ctrl, graph, LARGENIPARTS);
-
-		if (i == 0 || graph->mincut < mincut) {
-			mincut = graph->mincut;
-			if (i < ctrl->nseps-1)
-				icopy(graph->nvtxs, graph->where, bestwhere);
-		}
-
-		if (mincut == 0)	break;
-
-		if (i < ctrl->nseps-1)
-			FreeRData(graph);
-	}
-
-	if (mincut != graph->mincut) {
-		icopy(graph->nvtxs, bestwhere, graph->where);
-		Compute2WayNodePartitionParams(ctrl, graph);
-	}
-
-	WCOREPOP;
+	MlevelNodeBisectionTrialsBDF(ctrl, graph, ctrl->nseps, 2, LARGENIPARTS);
 }
 
 /*************************************************************************/
@@ -716,9 +1511,7 @@ void MlevelNodeBisectionMultipleBDF(ctrl_t *ctrl, graph_t *graph)
 /*************************************************************************/
 void MlevelNodeBisectionBDFL2(ctrl_t *ctrl, graph_t *graph, idx_t niparts)
 {
-	idx_t i, mincut, nruns = 2;	/* XXX magic number! */
 	graph_t *cgraph;
-	idx_t *bestwhere;
 
 	/* if the graph is small, just find a single vertex separator */
 	if (graph->nvtxs < 5000) {
@@ -726,30 +1519,142 @@ void MlevelNodeBisectionBDFL2(ctrl_t *ctrl, graph_t *graph, idx_t niparts)
 		return;
 	}
 
-	WCOREPUSH;
-
 	ctrl->CoarsenTo = gk_max(100, graph->nvtxs/30);
-	cgraph = CoarsenGraphNlevels(ctrl, graph, 4);	/* XXX magic number! */
+	if (ctrl->inherit)
+		cgraph = CoarsenGraphInherit(ctrl, graph, 4);	/* XXX magic number! */
+	else
+		cgraph = CoarsenGraphNlevels(ctrl, graph, 4);	/* XXX magic number! */
+
+	MlevelNodeBisectionTrialsBDF(ctrl, cgraph, 2, 1, 0.7*niparts);	/* XXX magic number! */
+
+	Refine2WayNode(ctrl, graph, cgraph);
+}
+
+/*************************************************************************/
+/*! This function computes ntrials node bisections of graph, with 
+    MlevelNodeBisectionBDFL2() if level is 2 and MlevelNodeBisectionBDFL1()
+    otherwise, and keeps the one with the smallest separator, the earliest
+    one on ties. 
+
+    Each trial is an OpenMP task, so the trials of the blocks bisected by
+    BisectBlockDiagsP() are spread over all its ctrl->nthreads threads, and
+    they run one after the other outside of a parallel region. A trial
+    bisects a private copy of the graph_t that shares the read-only arrays
+    of graph, with a private ctrl and gk_malloc core. With a single thread
+    the trials run inline on ctrl and its workspace instead. The seeds of
+    the trials are drawn before they start, so the separator does not
+    depend on the number of threads. Once a trial finds an empty separator,
+    the trials after it are not started, as none of them can be kept. */
+/*************************************************************************/
+void MlevelNodeBisectionTrialsBDF(ctrl_t *ctrl, graph_t *graph, idx_t ntrials, 
+		idx_t level, idx_t niparts)
+{
+	idx_t i, best, zero;
+	idx_t *seeds;
+	graph_t **tgraphs;
+	gk_mcore_t **mcores;
+
+	tgraphs = (graph_t **)gk_malloc(ntrials*sizeof(graph_t *), "MlevelNodeBisectionTrialsBDF: tgraphs");
+	mcores  = (gk_mcore_t **)gk_malloc(ntrials*sizeof(gk_mcore_t *), "MlevelNodeBisectionTrialsBDF: mcores");
+
+	/* the last seed restarts the generator of the calling thread afterwards */
+	seeds = imalloc(ntrials+1, "MlevelNodeBisectionTrialsBDF: seeds");
+	for (i=0; i<=ntrials; i++)
+		seeds[i] = irandInRange(IDX_MAX);
+
+	/* the first trial that found an empty separator */
+	zero = ntrials;
+
+	for (i=0; i<ntrials; i++) {
+		tgraphs[i] = NULL;
+		mcores[i]  = NULL;
+
+		#pragma omp task shared(zero) if(ctrl->nthreads > 1)
+		{
+			ctrl_t *wctrl;
+			graph_t *tgraph;
+			gk_mcore_t *omcore = NULL;
+			idx_t first;
+
+			#pragma omp atomic read
+			first = zero;
+
+			if (i < first) {
+				if (ctrl->nthreads > 1) {
+					omcore = gk_malloc_detach();
+					gk_malloc_init();
+				}
 
-	bestwhere = iwspacemalloc(ctrl, cgraph->nvtxs);
+				tgraph = tgraphs[i] = (graph_t *)gk_malloc(sizeof(graph_t), "MlevelNodeBisectionTrialsBDF: tgraph");
+				memcpy((void *)tgraph, (void *)graph, sizeof(graph_t));
+				tgraph->cmap    = NULL;
+				tgraph->where   = tgraph->pwgts = tgraph->id = tgraph->ed = NULL;
+				tgraph->bndptr  = tgraph->bndind = NULL;
+				tgraph->ckrinfo = NULL;
+				tgraph->vkrinfo = NULL;
+				tgraph->nrinfo  = NULL;
+				tgraph->coarser = tgraph->finer = NULL;
+				tgraph->chier   = CopyCHier(graph->chier);
+
+				wctrl = (ctrl->nthreads > 1 ? SetupWorkerCtrl(ctrl, graph) : ctrl);
+				InitRandom(seeds[i]);
+
+				if (level == 2)
+					MlevelNodeBisectionBDFL2(wctrl, tgraph, niparts);
+				else
+					MlevelNodeBisectionBDFL1(wctrl, tgraph, niparts);
+
+				if (tgraph->mincut == 0) {
+					#pragma omp critical (MlevelNodeBisectionTrialsBDF)
+					zero = gk_min(zero, i);
+				}
 
-	mincut = graph->tvwgt[0];
-	for (i=0; i<nruns; i++) {
-		MlevelNodeBisectionBDFL1(ctrl, cgraph, 0.7*niparts);
-		if (i == 0 || cgraph->mincut < mincut) {
-			mincut = cgraph->mincut;
-			if (i < nruns-1)	icopy(cgraph->nvtxs, cgraph->where, bestwhere);
+				if (ctrl->nthreads > 1) {
+					FreeWorkerCtrl(&wctrl);
+					mcores[i] = gk_malloc_detach();
+					gk_malloc_attach(omcore);
+				}
+			}
 		}
-		if (mincut == 0)	break;
-		if (i < nruns-1)	FreeRData(cgraph);
 	}
+	#pragma omp taskwait
 
-	if (mincut != cgraph->mincut)
-	icopy(cgraph->nvtxs, bestwhere, cgraph->where);
+	InitRandom(seeds[ntrials]);
 
-	WCOREPOP;
+	for (i=0; i<ntrials; i++)
+		gk_malloc_adopt(mcores[i]);
 
-	Refine2WayNode(ctrl, graph, cgraph);
+	/* all the trials up to zero have run */
+	for (best=0, i=1; i<gk_min(zero+1, ntrials); i++) {
+		if (tgraphs[i]->mincut < tgraphs[best]->mincut)
+			best = i;
+	}
+
+	/* the best trial hands its partition over to graph */
+	FreeRData(graph);
+	graph->mincut = tgraphs[best]->mincut;
+	graph->nbnd   = tgraphs[best]->nbnd;
+	graph->where  = tgraphs[best]->where;
+	graph->pwgts  = tgraphs[best]->pwgts;
+	graph->bndptr = tgraphs[best]->bndptr;
+	graph->bndind = tgraphs[best]->bndind;
+	graph->nrinfo = tgraphs[best]->nrinfo;
+
+	/* and the coarsening hierarchy it was found on, see ctrl->inherit */
+	FreeCHier(&graph->chier);
+	graph->chier = tgraphs[best]->chier;
+	tgraphs[best]->chier = NULL;
+
+	for (i=0; i<ntrials; i++) {
+		if (tgraphs[i] == NULL)
+			continue;
+		if (i != best)
+			FreeRData(tgraphs[i]);
+		FreeCHier(&tgraphs[i]->chier);
+		gk_free((void **)&tgraphs[i]->cmap, &tgraphs[i], LTERM);
+	}
+
+	gk_free((void **)&tgraphs, &mcores, &seeds, LTERM);
 }
 
 /*************************************************************************/
@@ -775,20 +1680,19 @@ void MlevelNodeBisectionBDFL1(ctrl_t *ctrl, graph_t *graph, idx_t niparts)
 }
 
 /*************************************************************************/
-/*! This function takes a graph and a tri-section (left, right, separator)
-    and splits it into two graphs.
+/*! This function takes a graph and a partition into ctrl->kappa parts and
+    a separator (where[i] == kappa) and splits it into kappa graphs.
 
     This function relies on the fact that adjwgt is all equal to 1.
 */
 /*************************************************************************/
-void SplitGraphOrderBDF(ctrl_t *ctrl, graph_t *graph, graph_t **r_lgraph, graph_t **r_rgraph)
+void SplitGraphOrderBDF(ctrl_t *ctrl, graph_t *graph, graph_t **sgraphs)
 {
-	idx_t i, ii, j, k, l, istart, iend, mypart, nvtxs, snvtxs[3], snedges[3];
-	idx_t *xadj, *vwgt, *adjncy, *adjwgt, *label, *where, *bndptr, *bndind;
-	idx_t *sxadj[2], *svwgt[2], *sadjncy[2], *sadjwgt[2], *slabel[2];
+	idx_t i, ii, j, k, l, istart, iend, mypart, nvtxs, nparts;
+	idx_t *xadj, *vwgt, *adjncy, *label, *where, *bndptr, *bndind;
+	idx_t *snvtxs, *snedges, *sxadj, *sadjncy;
 	idx_t *rename;
 	idx_t *auxadjncy;
-	graph_t *lgraph, *rgraph, *lrborder, *rrborder, *lcborder, *rcborder, *corner;
 
 	WCOREPUSH;
 
@@ -798,37 +1702,27 @@ void SplitGraphOrderBDF(ctrl_t *ctrl, graph_t *graph, graph_t **r_lgraph, graph_
 	xadj    = graph->xadj;
 	vwgt    = graph->vwgt;
 	adjncy  = graph->adjncy;
-	adjwgt  = graph->adjwgt;
 	label   = graph->label;
 	where   = graph->where;
 	bndptr  = graph->bndptr;
 	bndind  = graph->bndind;
+	nparts  = ctrl->kappa;
 	ASSERT(bndptr != NULL);
 
-	rename = iwspacemalloc(ctrl, nvtxs);
+	rename  = iwspacemalloc(ctrl, nvtxs);
+	snvtxs  = iset(nparts+1, 0, iwspacemalloc(ctrl, nparts+1));
+	snedges = iset(nparts+1, 0, iwspacemalloc(ctrl, nparts+1));
 
-	snvtxs[0] = snvtxs[1] = snvtxs[2] = snedges[0] = snedges[1] = snedges[2] = 0;
 	for (i = 0; i < nvtxs; i++) {
 		k = where[i];
 		rename[i] = snvtxs[k]++;	/* The vertex index of each vertex in a subgraph */
 		snedges[k] += xadj[i+1]-xadj[i];	/* XXX should not removed edges be deleted ? */
 	}
 
-	lgraph      = SetupSplitGraph(graph, snvtxs[0], snedges[0]);
-	sxadj[0]    = lgraph->xadj;
-	svwgt[0]    = lgraph->vwgt;
-	sadjncy[0]  = lgraph->adjncy;
-	sadjwgt[0]  = lgraph->adjwgt;
-	slabel[0]   = lgraph->label;
-
-	rgraph      = SetupSplitGraph(graph, snvtxs[1], snedges[1]);
-	sxadj[1]    = rgraph->xadj;
-	svwgt[1]    = rgraph->vwgt;
-	sadjncy[1]  = rgraph->adjncy;
-	sadjwgt[1]  = rgraph->adjwgt;
-	slabel[1]   = rgraph->label;
+	for (k = 0; k < nparts; k++)
+		sgraphs[k] = SetupSplitGraph(graph, snvtxs[k], snedges[k]);
 
-	/* Go and use bndptr to also mark the boundary nodes in the two partitions */
+	/* Go and use bndptr to also mark the boundary nodes in the parts */
 	for (ii = 0; ii < graph->nbnd; ii++) {
 		i = bndind[ii];
 		for (j = xadj[i]; j < xadj[i+1]; j++)
@@ -836,394 +1730,347 @@ void SplitGraphOrderBDF(ctrl_t *ctrl, graph_t *graph, graph_t **r_lgraph, graph_
 	}
 
 	/* restat snvtxs and snedges */
-	snvtxs[0] = snvtxs[1] = snedges[0] = snedges[1] = 0;
-	sxadj[0][0] = sxadj[1][0] = 0;
+	iset(nparts, 0, snvtxs);
+	iset(nparts, 0, snedges);
+	for (k = 0; k < nparts; k++)
+		sgraphs[k]->xadj[0] = 0;
 	for (i = 0; i < nvtxs; i++) {
-		if ((mypart = where[i]) == 2)
+		if ((mypart = where[i]) == nparts)
 			continue;
 
+		sxadj   = sgraphs[mypart]->xadj;
+		sadjncy = sgraphs[mypart]->adjncy;
+
 		istart = xadj[i];
 		iend   = xadj[i+1];
 		if (bndptr[i] == -1) { /* This is an interior vertex */
 			/* auxadjncy should be the start position to write adjacencies,
 			 * the reason for minus 'istart' is that the for loop starts from 'istart' */
-			auxadjncy = sadjncy[mypart] + snedges[mypart] - istart;
+			auxadjncy = sadjncy + snedges[mypart] - istart;
 			for(j = istart; j < iend; j++)
 				auxadjncy[j] = adjncy[j];
 			snedges[mypart] += iend - istart;
 		}
 		else {	/* This is a boundary vertex */
-			auxadjncy = sadjncy[mypart];
 			l = snedges[mypart];
 			for (j = istart; j < iend; j++) {
 				k = adjncy[j];
 				if (where[k] == mypart)
-					auxadjncy[l++] = k;
+					sadjncy[l++] = k;
 			}
 			snedges[mypart] = l;
 		}
 
-		svwgt[mypart][snvtxs[mypart]]    = vwgt[i];
-		slabel[mypart][snvtxs[mypart]]   = label[i];
-		sxadj[mypart][++snvtxs[mypart]]  = snedges[mypart];
+		sgraphs[mypart]->vwgt[snvtxs[mypart]]  = vwgt[i];
+		sgraphs[mypart]->label[snvtxs[mypart]] = label[i];
+		sxadj[++snvtxs[mypart]] = snedges[mypart];
 	}
 
-	for (mypart = 0; mypart < 2; mypart++) {
+	for (mypart = 0; mypart < nparts; mypart++) {
 		iend = snedges[mypart];
-		iset(iend, 1, sadjwgt[mypart]);
+		iset(iend, 1, sgraphs[mypart]->adjwgt);
 
-		auxadjncy = sadjncy[mypart];
+		auxadjncy = sgraphs[mypart]->adjncy;
 		for (i = 0; i < iend; i++)
 			auxadjncy[i] = rename[auxadjncy[i]];
-	}
 
-	lgraph->nvtxs  = snvtxs[0];
-	lgraph->nedges = snedges[0];
-	rgraph->nvtxs  = snvtxs[1];
-	rgraph->nedges = snedges[1];
+		sgraphs[mypart]->nvtxs  = snvtxs[mypart];
+		sgraphs[mypart]->nedges = snedges[mypart];
 
-	SetupGraph_tvwgt(lgraph);
-	SetupGraph_tvwgt(rgraph);
+		SetupGraph_tvwgt(sgraphs[mypart]);
+	}
 
-	IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->SplitTmr));
+	/* the subgraphs inherit the coarsening hierarchy of graph */
+	if (graph->chier != NULL) {
+		for (k = 0; k < nparts; k++)
+			sgraphs[k]->chier = RestrictCHier(ctrl, graph->chier, where, k);
+	}
 
-	*r_lgraph = lgraph;
-	*r_rgraph = rgraph;
+	IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->SplitTmr));
 
 	WCOREPOP;
 }
 
 /**
- * This function constructs lgraph and rgraph for a compressed graph 'before'
- * according to the separation results of 'after' and the relationship between
- * 'before' and 'after'. Note that the final lgraph and rgraph constructed
- * correspond to the original graph 'before'
- * XXX new nbnd, bndind, label of sort[i]->super should be modified in this function.
+ * This function constructs the subgraphs of graph from the separator
+ * found on its compressed graph cgraph. A vertex of graph is put into the
+ * part of the compressed vertex it has been merged into (cptr/cind), this
+ * keeps a valid separator as the merged vertices have identical adjacency
+ * lists. The separator is left in graph (where, bndind, ...) as
+ * SplitGraphOrderBDF() does.
  */
 void SplitGraphOrderUncompressBDF(ctrl_t *ctrl, graph_t *graph, graph_t *cgraph, idx_t *cptr,
-		idx_t *cind, graph_t **r_lgraph, graph_t **r_rgraph)
+		idx_t *cind, graph_t **sgraphs)
 {
-	/* construct perm from iperm */
-	/*
-	for (i=0; i<nnvtxs; i++)
-		perm[iperm[i]] = i;
-	for (l=ii=0; ii<nnvtxs; ii++) {
-		i = perm[ii];
-		for (j=cptr[i]; j<cptr[i+1]; j++)
-			iperm[cind[j]] = l++;
+	idx_t i, j, *where;
+
+	FreeRData(graph);
+
+	where = graph->where = imalloc(graph->nvtxs, "SplitGraphOrderUncompressBDF: where");
+	for (i = 0; i < cgraph->nvtxs; i++) {
+		for (j = cptr[i]; j < cptr[i+1]; j++)
+			where[cind[j]] = cgraph->where[i];
 	}
-	gk_free((void **)&cptr, &cind, LTERM);
-	*/
+
+	SetupSeparatorFromWhere(ctrl, graph);
+
+	SplitGraphOrderBDF(ctrl, graph, sgraphs);
 }
 
 /**
- * This function extracts a bigraph from the original graph according
- * to a subgraph (lgraph/rgraph) and boundary nodes.
+ * This function extracts the bigraphs of the nparts subgraphs (sgraphs)
+ * of a split of bigraph and of its separator.
  * Note: # of boundary nodes is nbnd = graph->nbnd
  *		indices of boundary is bndind = graph->bndind
  *		node label is stored in label = graph->label
  *	Namely, all necessary partitioning information has been prepared in graph.
- * 	/param graph is the original graph
- * 	/param sgraph is the subgraph split from the original graph
- * 	/param nrows is the total number of rows in the WHOLE original graph
+ * 	/param bigraph is the bigraph that was split
+ * 	/param sgraphs are the non-empty subgraphs split from bigraph->super
+ * 	/param children returns the nparts new bigraphs
  */
-void ExtractBiGraph(ctrl_t *ctrl, bigraph_t *bigraph, graph_t *lgraph, graph_t *rgraph,
-		bigraph_t **r_lbigraph, bigraph_t **r_rbigraph)
+void ExtractBiGraph(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, graph_t **sgraphs,
+		bigraph_t **children)
 {
-	bigraph_t *lbigraph = NULL, *rbigraph = NULL, *border = NULL;
-	bigraph_t *p, *q, *r, *s;
+	bigraph_t *child;
 	graph_t *graph = bigraph->super;
 	idx_t i, rj, cj;
-	idx_t lnrows = 0, lncols = 0;
-	idx_t rnrows = 0, rncols = 0;
 	idx_t nrbnds = 0, ncbnds = 0;
-	label_t *lrlabel, *lclabel, *rrlabel, *rclabel, *rblabel, *cblabel;
-	idx_t debugnz = 0, nz, area, snz, sarea;
+	label_t *rlabel, *clabel;
+	idx_t *rblabel, *cblabel;
+	idx_t **rlabels, **clabels, *snrows, *sncols;
+	idx_t s, t, u, ng, nb, nn, sep;
+	idx_t *bnz, *rnz, *cbnz;
+
+	WCOREPUSH;
+
+	rlabels = (idx_t **)gk_malloc((nparts+1)*sizeof(idx_t *), "ExtractBiGraph: rlabels");
+	clabels = (idx_t **)gk_malloc((nparts+1)*sizeof(idx_t *), "ExtractBiGraph: clabels");
+	snrows  = iset(nparts+1, 0, iwspacemalloc(ctrl, nparts+1));
+	sncols  = iset(nparts+1, 0, iwspacemalloc(ctrl, nparts+1));
 
 	/* stat # nodes in each block */
-	for (i = 0; i < lgraph->nvtxs; i++) {
-		if (lgraph->label[i] < ctrl->nrows)	lnrows++;
-		else	lncols++;
-	}
-	for (i = 0; i < rgraph->nvtxs; i++) {
-		if (rgraph->label[i] < ctrl->nrows)	rnrows++;
-		else	rncols++;
+	for (s = 0; s < nparts; s++) {
+		for (i = 0; i < sgraphs[s]->nvtxs; i++) {
+			if (sgraphs[s]->label[i] < ctrl->nrows)	snrows[s]++;
+			else	sncols[s]++;
+		}
 	}
 	for (i = 0; i < graph->nbnd; i++) {
 		if (graph->label[graph->bndind[i]] < ctrl->nrows)	nrbnds++;
 		else	ncbnds++;
 	}
-	/* allocate memory for commonly used labels
-	 * NOTE ! We use the same label for all borders in order to save memory! */
-	lrlabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : lrlabel");
-	lclabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : lclabel");
-	rrlabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : rrlabel");
-	rclabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : rclabel");
-	rblabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : rblabel");
-	cblabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : cblabel");
 
-	lrlabel->label = imalloc(lnrows, "ExtractBiGraph : lrlabel->label");
-	lclabel->label = imalloc(lncols, "ExtractBiGraph : lclabel->label");
-	rrlabel->label = imalloc(rnrows, "ExtractBiGraph : rrlabel->label");
-	rclabel->label = imalloc(rncols, "ExtractBiGraph : rclabel->label");
-	rblabel->label = imalloc(nrbnds, "ExtractBiGraph : rblabel->label");
-	cblabel->label = imalloc(ncbnds, "ExtractBiGraph : cblabel->label");
-
-	lrlabel->ref = lclabel->ref = rrlabel->ref = rclabel->ref = rblabel->ref = cblabel->ref = 0;
+	/* construct the new bigraphs, with their own labels */
+	for (s = 0; s < nparts; s++) {
+		rlabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : rlabel");
+		clabel = (label_t*)gk_malloc(sizeof(label_t), "ExtractBiGraph : clabel");
+		rlabel->label = imalloc(snrows[s], "ExtractBiGraph : rlabel->label");
+		clabel->label = imalloc(sncols[s], "ExtractBiGraph : clabel->label");
+		rlabel->ref = clabel->ref = 0;
+
+		for (rj = cj = i = 0; i < sgraphs[s]->nvtxs; i++) {
+			if (sgraphs[s]->label[i] < ctrl->nrows)	rlabel->label[rj++] = sgraphs[s]->label[i];
+			else	clabel->label[cj++] = sgraphs[s]->label[i];
+		}
 
-	for (rj = cj = i = 0; i < lgraph->nvtxs; i++) {
-		if (lgraph->label[i] < ctrl->nrows)	lrlabel->label[rj++] = lgraph->label[i];
-		else	lclabel->label[cj++] = lgraph->label[i];
-	}
-	for (rj = cj = i = 0; i < rgraph->nvtxs; i++) {
-		if (rgraph->label[i] < ctrl->nrows)	rrlabel->label[rj++] = rgraph->label[i];
-		else	rclabel->label[cj++] = rgraph->label[i];
+		children[s] = SetupBiGraphFromGraph(sgraphs[s], snrows[s], sncols[s], ctrl->nrows, ctrl->ncols,
+				rlabel, clabel);
+		rlabels[s] = rlabel->label;
+		clabels[s] = clabel->label;
 	}
+
+	/* the separator becomes a border group shared by all new blocks */
+	rblabel = imalloc(nrbnds, "ExtractBiGraph : rblabel");
+	cblabel = imalloc(ncbnds, "ExtractBiGraph : cblabel");
 	for (rj = cj = i = 0; i < graph->nbnd; i++) {
-		if (graph->label[graph->bndind[i]] < ctrl->nrows)	rblabel->label[rj++] = graph->label[graph->bndind[i]];
-		else	cblabel->label[cj++] = graph->label[graph->bndind[i]];
-	}
-
-	gk_startcputimer(_nztimer);	/* TODO exp timer */
-
-	/* construct two bigraphs */
-	lbigraph = SetupBiGraphFromGraph(lgraph, lnrows, lncols, ctrl->nrows, ctrl->ncols, lrlabel, lclabel);
-
-	/* construct the fist column border */
-	border = CreateBorder(lnrows, ncbnds, StatNonZeros(ctrl, lrlabel, cblabel, lnrows, ncbnds), lrlabel, cblabel);
-	lbigraph->right = border;
-
-	/* split original column borders for new column borders */
-	p = border;
-	q = bigraph->right;
-	while (q) {
-		border = CreateBorder(lnrows, q->ncols, StatNonZeros(ctrl, lrlabel, q->clabel, lnrows, q->ncols), lrlabel, q->clabel);
-		p->right = border;
-		p = p->right;
-		q = q->right;
-	}
-
-	/* construct the first row border */
-	border = CreateBorder(nrbnds, lncols, StatNonZeros(ctrl, rblabel, lclabel, nrbnds, lncols), rblabel, lclabel);
-	lbigraph->down = border;
-
-	/* construct the conner */
-	p = border;
-	border = CreateBorder(nrbnds, ncbnds, StatNonZeros(ctrl, rblabel, cblabel, nrbnds, ncbnds), rblabel, cblabel);
-	debugnz = border->nz;
-	p->right = border;
-
-	/* split original column borders for new conners */
-	p = border;
-	q = bigraph->right;
-	while (q) {
-		border = CreateBorder(nrbnds, q->ncols, StatNonZeros(ctrl, rblabel, q->clabel, nrbnds, q->ncols), rblabel, q->clabel);
-		p->right = border;
-		p = p->right;
-		q = q->right;
-	}
-
-	/* split original row borders for new row borders/corners,
-	 * connect orginal cornners to the new bigraph */
-	p = lbigraph->down;
-	q = bigraph->down;
-	while (q) {
-		/* row border from original row border */
-		border = CreateBorder(q->nrows, lncols, StatNonZeros(ctrl, q->rlabel, lclabel, q->nrows, lncols), q->rlabel, lclabel);
-		p->down = border;
-		p = p->down;
-		/* row conner from original row border */
-		p->right = CreateBorder(q->nrows, ncbnds, StatNonZeros(ctrl, q->rlabel, cblabel, q->nrows, ncbnds), q->rlabel, cblabel);
-		/* connect the original cornners */
-		s = p->right;
-		r = q->right;
-		while (r) {
-			s->right = CreateBorder(r->nrows, r->ncols, r->nz, r->rlabel, r->clabel);
-			r->rlabel->ref++;	r->clabel->ref++;
-			s = s->right;
-			r = r->right;
-		}
-		q = q->down;
-	}
-
-	/************************************************************/
-	/* construct the right bigraph */
-	rbigraph = SetupBiGraphFromGraph(rgraph, rnrows, rncols, ctrl->nrows, ctrl->ncols, rrlabel, rclabel);
-
-	/* construct the fist column border */
-	border = CreateBorder(rnrows, ncbnds, StatNonZeros(ctrl, rrlabel, cblabel, rnrows, ncbnds), rrlabel, cblabel);
-	rbigraph->right = border;
-
-	/* split original column borders for new column borders */
-	p = border;
-	q = bigraph->right;
-	while (q) {
-		border = CreateBorder(rnrows, q->ncols, StatNonZeros(ctrl, rrlabel, q->clabel, rnrows, q->ncols), rrlabel, q->clabel);
-		p->right = border;
-		p = p->right;
-		q = q->right;
-	}
-
-	/* construct the first row border */
-	border = CreateBorder(nrbnds, rncols, StatNonZeros(ctrl, rblabel, rclabel, nrbnds, rncols), rblabel, rclabel);
-	rbigraph->down = border;
-
-	/* construct the conner */
-	p = border;
-	border = CreateBorder(nrbnds, ncbnds, StatNonZeros(ctrl, rblabel, cblabel, nrbnds, ncbnds), rblabel, cblabel);
-	p->right = border;
-
-	/* split original column borders for new conners */
-	p = border;
-	q = bigraph->right;
-	while (q) {
-		border = CreateBorder(nrbnds, q->ncols, StatNonZeros(ctrl, rblabel, q->clabel, nrbnds, q->ncols), rblabel, q->clabel);
-		p->right = border;
-		p = p->right;
-		q = q->right;
-	}
-
-	/* split original row borders for new row borders/corners,
-	 * connect orginal cornners to the new bigraph */
-	p = rbigraph->down;
-	q = bigraph->down;
-	while (q) {
-		/* row border from original row border */
-		border = CreateBorder(q->nrows, rncols, StatNonZeros(ctrl, q->rlabel, rclabel, q->nrows, rncols), q->rlabel, rclabel);
-		p->down = border;
-		p = p->down;
-		/* row conner from original row border */
-		p->right = CreateBorder(q->nrows, ncbnds, StatNonZeros(ctrl, q->rlabel, cblabel, q->nrows, ncbnds), q->rlabel, cblabel);
-		/* connect the original cornners */
-		s = p->right;
-		r = q->right;
-		while (r) {
-			s->right = CreateBorder(r->nrows, r->ncols, r->nz, r->rlabel, r->clabel);
-			s = s->right;
-			r = r->right;
+		if (graph->label[graph->bndind[i]] < ctrl->nrows)	rblabel[rj++] = graph->label[graph->bndind[i]];
+		else	cblabel[cj++] = graph->label[graph->bndind[i]];
+	}
+
+	gk_startcputimer(ctrl->stats->nztimer);	/* TODO exp timer */
+
+	sep = AddBorder(ctrl, nrbnds, ncbnds, rblabel, cblabel);
+
+	/* count the non-zeros of all new borders at once */
+	nb = bigraph->nbrds;
+	ng = nparts + 1 + nb;
+
+	rlabels[nparts] = rblabel;
+	clabels[nparts] = cblabel;
+	snrows[nparts]  = nrbnds;
+	sncols[nparts]  = ncbnds;
+
+	bnz = iwspacemalloc(ctrl, (nparts+1)*ng);
+	rnz = iwspacemalloc(ctrl, (nparts+1)*nb);
+	StatBorderNonZeros(ctrl, bigraph, nparts, rlabels, clabels, snrows, sncols, bnz, rnz);
+
+	/* The border groups of all blocks are the separator followed by those of
+	 * bigraph. In the (nb+2)x(nb+2) non-zero matrix of the s-th block, row/column
+	 * 1 is the separator, row/column 2+t is the t-th border group of bigraph, and
+	 * the cells between two border groups are taken over from bigraph */
+	nn = nb + 2;
+	for (s = 0; s < nparts; s++) {
+		child = children[s];
+
+		child->nbrds = nb + 1;
+		child->brds  = imalloc(nb+1 + nn*nn, "ExtractBiGraph: child->brds");
+		child->bnz   = child->brds + nb+1;
+
+		child->brds[0] = sep;
+		for (t = 0; t < nb; t++)
+			child->brds[t+1] = bigraph->brds[t];
+		for (t = 0; t < nb+1; t++)
+			ctrl->borders[child->brds[t]].ref++;
+
+		cbnz = child->bnz;
+		cbnz[0]    = child->nz;
+		cbnz[1]    = bnz[s*ng+nparts];
+		cbnz[nn]   = bnz[nparts*ng+s];
+		cbnz[nn+1] = bnz[nparts*ng+nparts];
+		for (t = 0; t < nb; t++) {
+			cbnz[2+t]        = bnz[s*ng+nparts+1+t];
+			cbnz[nn+2+t]     = bnz[nparts*ng+nparts+1+t];
+			cbnz[(2+t)*nn]   = rnz[t*(nparts+1)+s];
+			cbnz[(2+t)*nn+1] = rnz[t*(nparts+1)+nparts];
+			for (u = 0; u < nb; u++)
+				cbnz[(2+t)*nn+2+u] = bigraph->bnz[(1+t)*(nb+1)+1+u];
 		}
-		q = q->down;
+
+		/* subtotals of the new bigraph, used for scoring the split in O(1) */
+		StatNzAndArea(ctrl, child, &child->snz, &child->sarea, 0);
 	}
 
-	gk_stopcputimer(_nztimer);	/* TODO exp timer */
+	gk_stopcputimer(ctrl->stats->nztimer);	/* TODO exp timer */
 
-	*r_lbigraph = lbigraph;
-	*r_rbigraph = rbigraph;
+	gk_free((void **)&rlabels, &clabels, LTERM);
 
-	ASSERT(CheckArea(bigraph, lbigraph, rbigraph));	/* TODO debug */
-	ASSERT(CheckNonZeros(bigraph, lbigraph, rbigraph));	/*TODO debug*/
-}
+	WCOREPOP;
 
-void swap(idx_t *x,idx_t *y)
-{
-   idx_t temp;
-   temp = *x;
-   *x = *y;
-   *y = temp;
+	ASSERT(CheckArea(ctrl, bigraph, nparts, children));	/* TODO debug */
+	ASSERT(CheckNonZeros(ctrl, bigraph, nparts, children));	/*TODO debug*/
 }
 
-int choose_pivot(int i,int j )
+/**
+ * This function appends the separator with the given rows and columns to
+ * the border table ctrl->borders and returns its id. The table takes over
+ * rlabel and clabel, which are freed when the last bigraph using the
+ * border group is freed.
+ */
+idx_t AddBorder(ctrl_t *ctrl, idx_t nrows, idx_t ncols, idx_t *rlabel, idx_t *clabel)
 {
-   return((i+j) /2);
+	border_t *border;
+
+	if (ctrl->nborders == ctrl->maxborders) {
+		ctrl->maxborders = gk_max(2*ctrl->maxborders, 64);
+		ctrl->borders = (border_t *)gk_realloc(ctrl->borders, ctrl->maxborders*sizeof(border_t),
+				"AddBorder: borders");
+	}
+
+	border = ctrl->borders + ctrl->nborders;
+	border->nrows  = nrows;
+	border->ncols  = ncols;
+	border->rlabel = rlabel;
+	border->clabel = clabel;
+	border->ref    = 0;
+
+	return ctrl->nborders++;
 }
 
-void quicksort(idx_t list[],int m,int n)
+/**
+ * This function counts the non-zeros of all the new borders of a split in a
+ * single sweep over the original graph. The columns are marked in ctrl->bndmark
+ * by their column group: 0..nparts-1 for the columns of the new blocks, nparts
+ * for the separator columns and nparts+1+t for the t-th border group of bigraph.
+ * Then the adjacencies of the rows of bigraph and of its border groups are
+ * scanned once, and the marks are cleared again.
+ * 	\param rlabels/clabels are the rows/columns of the new blocks and of the separator
+ * 	\param nrows/ncols are the corresponding sizes of rlabels/clabels
+ * 	\param bnz is of size (nparts+1)*ng, ng = nparts+1+nbrds, bnz[i*ng+g] returns
+ * 	the non-zeros between row group i (the i-th block, or the separator for
+ * 	i == nparts) and column group g
+ * 	\param rnz is of size nbrds*(nparts+1), rnz[t*(nparts+1)+g] returns the
+ * 	non-zeros between the rows of the t-th border group of bigraph and column
+ * 	group g (g <= nparts)
+ */
+void StatBorderNonZeros(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, idx_t **rlabels,
+		idx_t **clabels, idx_t *nrows, idx_t *ncols, idx_t *bnz, idx_t *rnz)
 {
-   int i,j,k;
-   idx_t key;
-   if( m < n)
-   {
-      k = choose_pivot(m,n);
-      swap(&list[m],&list[k]);
-      key = list[m];
-      i = m+1;
-      j = n;
-      while(i <= j)
-      {
-         while((i <= n) && (list[i] <= key))
-                i++;
-         while((j >= m) && (list[j] > key))
-                j--;
-         if( i < j)
-                swap(&list[i],&list[j]);
-      }
-      swap(&list[m],&list[j]);
-      quicksort(list,m,j-1);
-      quicksort(list,j+1,n);
-   }
-}
+	idx_t i, j, g, t, v, ng;
+	idx_t *xadj, *adjncy, *mark;
+	border_t *border;
+
+	xadj   = ctrl->obigraph->super->xadj;
+	adjncy = ctrl->obigraph->super->adjncy;
+	mark   = ctrl->bndmark;
+	ng     = nparts + 1 + bigraph->nbrds;
+
+	/* mark the column groups */
+	for (g = 0; g <= nparts; g++) {
+		for (i = 0; i < ncols[g]; i++)
+			mark[clabels[g][i]] = g;
+	}
+	for (t = 0; t < bigraph->nbrds; t++) {
+		border = ctrl->borders + bigraph->brds[t];
+		for (i = 0; i < border->ncols; i++)
+			mark[border->clabel[i]] = nparts+1+t;
+	}
 
-idx_t StatNonZeros(ctrl_t *ctrl, label_t *rlabel, label_t *clabel, idx_t nrows, idx_t ncols) {
-	idx_t i, j, k;
-	idx_t istart, iend, adj;
-	idx_t nz = 0;
-	if (nrows < ncols) {
-		idx_t *tmp = (idx_t*)malloc(sizeof(idx_t)*ncols);
-	        for (i = 0; i < ncols; i++)
-				tmp[i] = clabel->label[i];
-		quicksort(tmp, 0, ncols-1);	
-		for (i = 0; i < nrows; i++) {
-			istart = ctrl->obigraph->super->xadj[rlabel->label[i]];
-			iend = ctrl->obigraph->super->xadj[rlabel->label[i]+1];
-			for (j = istart; j < iend; j++) {
-				adj = ctrl->obigraph->super->adjncy[j];
-				int head = 0, tail = ncols, mid = (head + tail) / 2;
-				while (head < tail-1)
-				{
-					if (tmp[mid] <= adj) head = mid;
-					else tail = mid;
-					mid = (head + tail) / 2;
-				}
-				if (tmp[head] == adj)
-					nz++;
+	/* the rows of bigraph against all column groups */
+	iset((nparts+1)*ng, 0, bnz);
+	for (g = 0; g <= nparts; g++) {
+		for (i = 0; i < nrows[g]; i++) {
+			v = rlabels[g][i];
+			for (j = xadj[v]; j < xadj[v+1]; j++) {
+				if ((t = mark[adjncy[j]]) >= 0)
+					bnz[g*ng+t]++;
 			}
 		}
-		free(tmp);
 	}
-	else {
-		idx_t *tmp = (idx_t*)malloc(sizeof(idx_t)*nrows);
-	        for (i = 0; i < nrows; i++)
-			tmp[i] = rlabel->label[i];
-		quicksort(tmp, 0, nrows-1);	
-		for (i = 0; i < ncols; i++) {
-			istart = ctrl->obigraph->super->xadj[clabel->label[i]];
-			iend = ctrl->obigraph->super->xadj[clabel->label[i]+1];
-			for (j = istart; j < iend; j++) {
-				adj = ctrl->obigraph->super->adjncy[j];
-				int head = 0, tail = nrows, mid = (head + tail) / 2;
-				int o1=0, o2= 0;
-				while (head < tail-1)
-				{
-					if (tmp[mid] <= adj) head = mid;
-					else tail = mid;
-					mid = (head + tail) / 2;
-				}
-				if (tmp[head] == adj)
-				{
-					nz++;
-				}
+
+	/* the rows of the border groups against the new column groups, the
+	 * non-zeros between two border groups are kept */
+	iset((nparts+1)*bigraph->nbrds, 0, rnz);
+	for (t = 0; t < bigraph->nbrds; t++) {
+		border = ctrl->borders + bigraph->brds[t];
+		for (i = 0; i < border->nrows; i++) {
+			v = border->rlabel[i];
+			for (j = xadj[v]; j < xadj[v+1]; j++) {
+				g = mark[adjncy[j]];
+				if (g >= 0 && g <= nparts)
+					rnz[t*(nparts+1)+g]++;
 			}
 		}
-		free(tmp);
 	}
 
-	return nz;
+	/* clear the marks */
+	for (g = 0; g <= nparts; g++) {
+		for (i = 0; i < ncols[g]; i++)
+			mark[clabels[g][i]] = -1;
+	}
+	for (t = 0; t < bigraph->nbrds; t++) {
+		border = ctrl->borders + bigraph->brds[t];
+		for (i = 0; i < border->ncols; i++)
+			mark[border->clabel[i]] = -1;
+	}
 }
 
 /**
- * This function checks whether the area after partitioning is equal
- * to that before partitioning.
+ * This function checks whether the rows and columns after partitioning
+ * cover those before partitioning.
  */
-idx_t CheckArea(bigraph_t *bigraph, bigraph_t *lbigraph, bigraph_t *rbigraph){
-	idx_t sarea = 0, sareabytimes = 0;
-
-	sarea += lbigraph->area + lbigraph->right->area + lbigraph->down->area + lbigraph->down->right->area;
-	sarea += rbigraph->area + rbigraph->right->area + rbigraph->down->area + rbigraph->down->right->area;
-	sarea -= lbigraph->down->right->area;
-	sarea += lbigraph->nrows * rbigraph->ncols + rbigraph->nrows * lbigraph->ncols;
+idx_t CheckArea(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, bigraph_t **children){
+	idx_t s, nrows, ncols;
+	border_t *sep = ctrl->borders + children[0]->brds[0];
+
+	nrows = sep->nrows;
+	ncols = sep->ncols;
+	for (s = 0; s < nparts; s++) {
+		nrows += children[s]->nrows;
+		ncols += children[s]->ncols;
+	}
 
-	if (sarea != bigraph->area)	return 0;
-	if (sarea != bigraph->nrows * bigraph->ncols) return 0;
+	if (nrows != bigraph->nrows || ncols != bigraph->ncols)	return 0;
+	if (nrows * ncols != bigraph->area) return 0;
 
 	return 1;
 }
@@ -1232,30 +2079,24 @@ idx_t CheckArea(bigraph_t *bigraph, bigraph_t *lbigraph, bigraph_t *rbigraph){
  * This function checks whether the total non-zeros after partitioning is equal
  * to that before partitioning.
  */
-int CheckNonZeros(bigraph_t *bigraph, bigraph_t *lbigraph, bigraph_t *rbigraph) {
+int CheckNonZeros(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, bigraph_t **children) {
 	idx_t onz = 0, nnz = 0, nz;
-	idx_t area;
-	bigraph_t *p, *q;
+	idx_t area, i, j, s, nn;
 
-	StatNzAndArea(bigraph, &nz, &area, 0);
+	StatNzAndArea(ctrl, bigraph, &nz, &area, 0);
 	onz = nz;
 
-	StatNzAndArea(lbigraph, &nz, &area, 0);
-	nnz += nz;
-	StatNzAndArea(rbigraph, &nz, &area, 0);
-	nnz += nz;
+	for (s = 0; s < nparts; s++) {
+		StatNzAndArea(ctrl, children[s], &nz, &area, 0);
+		nnz += nz;
+	}
 
-	nz = 0;
-	p = lbigraph->down;
-	while (p) {
-		q = p->right;
-		while (q) {
-			nz += q->nz;
-			q = q->right;
-		}
-		p = p->down;
+	/* the cells between two border groups are counted by all blocks */
+	nn = children[0]->nbrds + 1;
+	for (i = 1; i < nn; i++) {
+		for (j = 1; j < nn; j++)
+			nnz -= (nparts-1) * children[0]->bnz[i*nn+j];
 	}
-	nnz -= nz;
 
 	if (nnz != onz) {
 		printf("***ERROR : non-zero error !\n");
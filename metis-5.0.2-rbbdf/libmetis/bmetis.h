@@ -1,21 +0,0 @@
-#ifndef _RBBDF_H_
-#define _RBBDF_H_
-
-#include "metis.h"
-
-real_t _parttimer;
-real_t _nztimer;
-
-idx_t _totalcheck;
-idx_t _firsthit;
-
-idx_t _maxarea;
-idx_t _maxnz;
-idx_t _minarea;
-idx_t _minnz;
-real_t _avgarea;
-real_t _avgnz;
-real_t _maxdense;
-real_t _mindense;
-
-#endif
@@ -13,6 +13,8 @@
 
 #define MAXDEGREEFOR2HOP  20  /* The maximum degree of a vertex to be considered
                                  for matching with a 2-hop neighbor */
+#define PMATCHNROUNDS     8   /* The maximum number of handshake rounds of 
+                                 Match_PHEM() */
 
 
 /*************************************************************************/
@@ -57,6 +59,9 @@ graph_t *CoarsenGraph(ctrl_t *ctrl, graph_t *graph)
         else
           Match_SHEM(ctrl, graph);
         break;
+      case METIS_CTYPE_PHEM:
+        Match_PHEM(ctrl, graph, !eqewgts);
+        break;
       default:
         gk_errexit(SIGERR, "Unknown ctype: %d\n", ctrl->ctype);
     }
@@ -120,6 +125,9 @@ graph_t *CoarsenGraphNlevels(ctrl_t *ctrl, graph_t *graph, idx_t nlevels)
         else
           Match_SHEM(ctrl, graph);
         break;
+      case METIS_CTYPE_PHEM:
+        Match_PHEM(ctrl, graph, !eqewgts);
+        break;
       default:
         gk_errexit(SIGERR, "Unknown ctype: %d\n", ctrl->ctype);
     }
@@ -142,6 +150,192 @@ graph_t *CoarsenGraphNlevels(ctrl_t *ctrl, graph_t *graph, idx_t nlevels)
 }
 
 
+/*************************************************************************/
+/*! This function is CoarsenGraphNlevels() for a graph that was split off
+    a block whose coarsening hierarchy it inherited in graph->chier 
+    (ctrl->inherit). The levels of the hierarchy are contracted as they 
+    are, without matching, as long as they reduce the graph enough, and 
+    the remaining levels are matched as usual. The hierarchy of all the
+    levels replaces graph->chier, to be restricted to the subgraphs split
+    off graph in turn. */
+/*************************************************************************/
+graph_t *CoarsenGraphInherit(ctrl_t *ctrl, graph_t *graph, idx_t nlevels)
+{
+  idx_t v, c, level, nvtxs, cnvtxs, done=0;
+  idx_t *cmap, *match, *first;
+  chier_t *chier;
+  graph_t *cgraph;
+
+  IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_startcputimer(ctrl->CoarsenTmr));
+
+  chier  = graph->chier;
+  cgraph = graph;
+
+  for (level=0; chier != NULL && level<gk_min(nlevels, chier->nlevels); level++) {
+    nvtxs  = cgraph->nvtxs;
+    cnvtxs = chier->nvtxs[level+1];
+    ASSERT(nvtxs == chier->nvtxs[level]);
+
+    /* the levels that do not reduce the graph enough are matched again */
+    if (cnvtxs > COARSEN_FRACTION*nvtxs)
+      break;
+
+    IFSET(ctrl->dbglvl, METIS_DBG_COARSEN, PrintCGraphStats(ctrl, cgraph));
+
+    WCOREPUSH;
+
+    if (cgraph->cmap == NULL)
+      cgraph->cmap = imalloc(nvtxs, "CoarsenGraphInherit: cgraph->cmap");
+    cmap = icopy(nvtxs, chier->cmap+chier->ptr[level], cgraph->cmap);
+
+    /* the (at most two) vertices of each coarse vertex are matched */
+    match = iwspacemalloc(ctrl, nvtxs);
+    first = iset(cnvtxs, -1, iwspacemalloc(ctrl, cnvtxs));
+    for (v=0; v<nvtxs; v++) {
+      c = cmap[v];
+      if (first[c] == -1) {
+        first[c] = v;
+        match[v] = v;
+      }
+      else {
+        match[v] = first[c];
+        match[first[c]] = v;
+      }
+    }
+
+    CreateCoarseGraph(ctrl, cgraph, cnvtxs, match);
+
+    WCOREPOP;
+
+    cgraph = cgraph->coarser;
+
+    ASSERT(CheckGraph(cgraph, 0, 1));
+
+    if (cgraph->nvtxs < ctrl->CoarsenTo || cgraph->nedges < cgraph->nvtxs/2) {
+      done = 1;
+      break;
+    }
+  }
+
+  IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->CoarsenTmr));
+
+  if (!done && level < nlevels)
+    cgraph = CoarsenGraphNlevels(ctrl, cgraph, nlevels-level);
+  else
+    IFSET(ctrl->dbglvl, METIS_DBG_COARSEN, PrintCGraphStats(ctrl, cgraph));
+
+  FreeCHier(&graph->chier);
+  graph->chier = SetupCHier(graph, cgraph);
+
+  return cgraph;
+}
+
+
+/*************************************************************************/
+/*! This function returns the coarsening hierarchy of the levels from 
+    graph down to cgraph, or NULL if there are none */
+/*************************************************************************/
+chier_t *SetupCHier(graph_t *graph, graph_t *cgraph)
+{
+  idx_t l, nlevels, ncmap;
+  graph_t *g;
+  chier_t *chier;
+
+  for (nlevels=0, ncmap=0, g=graph; g != cgraph; g=g->coarser) {
+    nlevels++;
+    ncmap += g->nvtxs;
+  }
+  if (nlevels == 0)
+    return NULL;
+
+  chier = CreateCHier(nlevels, ncmap);
+
+  for (ncmap=0, l=0, g=graph; g != cgraph; l++, g=g->coarser) {
+    chier->nvtxs[l] = g->nvtxs;
+    chier->ptr[l]   = ncmap;
+    icopy(g->nvtxs, g->cmap, chier->cmap+ncmap);
+    ncmap += g->nvtxs;
+  }
+  chier->nvtxs[nlevels] = cgraph->nvtxs;
+
+  return chier;
+}
+
+
+/*************************************************************************/
+/*! This function restricts a coarsening hierarchy to the vertices v with
+    where[v] == part, numbered in their order, i.e., to the subgraph of 
+    part that SplitGraphOrderBDF() extracts. The coarse vertices of each 
+    level are the coarse vertices of chier that some vertex of the level
+    above is mapped to, so the partners outside of the subgraph are left
+    unmatched. The levels below the first one that does not reduce the 
+    subgraph by COARSEN_FRACTION are dropped. It returns NULL if no level
+    is left. */
+/*************************************************************************/
+chier_t *RestrictCHier(ctrl_t *ctrl, chier_t *chier, idx_t *where, idx_t part)
+{
+  idx_t i, l, c, nvtxs, snvtxs, cnvtxs, nlevels, ncmap;
+  idx_t *pcmap, *scmap, *ids, *cids, *mark, *tmp;
+  chier_t *schier;
+
+  WCOREPUSH;
+
+  nvtxs = chier->nvtxs[0];
+
+  /* ids[] are the vertices of chier that make up the current level */
+  ids  = iwspacemalloc(ctrl, nvtxs);
+  cids = iwspacemalloc(ctrl, nvtxs);
+  mark = iset(nvtxs, -1, iwspacemalloc(ctrl, nvtxs));
+
+  for (snvtxs=0, i=0; i<nvtxs; i++) {
+    if (where[i] == part)
+      ids[snvtxs++] = i;
+  }
+
+  /* the levels shrink, so nlevels*snvtxs is enough for now */
+  schier = CreateCHier(chier->nlevels, chier->nlevels*snvtxs);
+  schier->nvtxs[0] = snvtxs;
+
+  for (nlevels=0, ncmap=0, l=0; l<chier->nlevels && snvtxs > 0; l++) {
+    pcmap = chier->cmap + chier->ptr[l];
+    scmap = schier->cmap + ncmap;
+
+    for (cnvtxs=0, i=0; i<snvtxs; i++) {
+      c = pcmap[ids[i]];
+      if (mark[c] == -1) {
+        mark[c] = cnvtxs;
+        cids[cnvtxs++] = c;
+      }
+      scmap[i] = mark[c];
+    }
+    for (i=0; i<cnvtxs; i++)
+      mark[cids[i]] = -1;
+
+    if (cnvtxs > COARSEN_FRACTION*snvtxs)
+      break;
+
+    schier->ptr[nlevels]     = ncmap;
+    schier->nvtxs[++nlevels] = cnvtxs;
+    ncmap += snvtxs;
+
+    gk_SWAP(ids, cids, tmp);
+    snvtxs = cnvtxs;
+  }
+
+  WCOREPOP;
+
+  if (nlevels == 0) {
+    FreeCHier(&schier);
+    return NULL;
+  }
+
+  schier->nlevels = nlevels;
+  schier->cmap    = irealloc(schier->cmap, ncmap, "RestrictCHier: cmap");
+
+  return schier;
+}
+
+
 /*************************************************************************/
 /*! This function finds a matching by randomly selecting one of the 
     unmatched adjacent vertices. 
@@ -459,6 +653,159 @@ idx_t Match_SHEM(ctrl_t *ctrl, graph_t *graph)
 }
 
 
+/**************************************************************************/
+/*! This function finds a heavy-edge matching in rounds of handshakes, so 
+    that it can be computed by concurrent tasks. In each round, every 
+    unmatched vertex points to the unmatched neighbor it can be matched 
+    with over the heaviest edge (any edge if heavy is 0), ties are broken 
+    by a random key of the neighbor, and the vertices that point to each 
+    other are matched. A round only reads the matching of the previous 
+    one, so the matching depends on the seed but not on the number of 
+    threads. Unlike Match_SHEM(), no 2-hop matching is attempted.
+    With a single thread, the rounds only cost more than Match_SHEM() 
+    does, so the matching of METIS_CTYPE_SHEM is used instead.
+ */
+/**************************************************************************/
+idx_t Match_PHEM(ctrl_t *ctrl, graph_t *graph, idx_t heavy)
+{
+  idx_t i, j, t, nvtxs, ncon, cnvtxs, nchunks, round, nmatched, 
+        maxidx, last_unmatched;
+  idx_t *xadj, *vwgt, *adjncy, *adjwgt, *maxvwgt;
+  idx_t *match, *cmap, *pref, *keys, *counts;
+
+  if (ctrl->nthreads <= 1)
+    return (heavy && graph->nedges > 0 ? Match_SHEM(ctrl, graph) : Match_RM(ctrl, graph));
+
+  WCOREPUSH;
+
+  IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_startcputimer(ctrl->MatchTmr));
+
+  nvtxs  = graph->nvtxs;
+  ncon   = graph->ncon;
+  xadj   = graph->xadj;
+  vwgt   = graph->vwgt;
+  adjncy = graph->adjncy;
+  adjwgt = graph->adjwgt;
+  cmap   = graph->cmap;
+
+  maxvwgt = ctrl->maxvwgt;
+
+  /* the vertices are split into one range per thread */
+  nchunks = ctrl->nthreads;
+
+  match  = iset(nvtxs, UNMATCHED, iwspacemalloc(ctrl, nvtxs));
+  pref   = iwspacemalloc(ctrl, nvtxs);
+  keys   = iwspacemalloc(ctrl, nvtxs);
+  counts = iwspacemalloc(ctrl, nchunks);
+
+  irandArrayPermuteFine(nvtxs, keys, 1);
+
+  for (round=0; round<PMATCHNROUNDS; round++) {
+    /* every unmatched vertex points to its preferred unmatched neighbor */
+    #pragma omp taskloop grainsize(1)
+    for (t=0; t<nchunks; t++) {
+      idx_t i, j, k, iend, maxidx, maxwgt;
+
+      for (i=t*nvtxs/nchunks, iend=(t+1)*nvtxs/nchunks; i<iend; i++) {
+        pref[i] = -1;
+        if (match[i] != UNMATCHED || 
+            !(ncon == 1 ? vwgt[i] < maxvwgt[0] : ivecle(ncon, vwgt+i*ncon, maxvwgt)))
+          continue;
+
+        for (maxidx=-1, maxwgt=-1, j=xadj[i]; j<xadj[i+1]; j++) {
+          k = adjncy[j];
+          if (match[k] != UNMATCHED || 
+              !(ncon == 1 ? vwgt[i]+vwgt[k] <= maxvwgt[0] :
+                            ivecaxpylez(ncon, 1, vwgt+i*ncon, vwgt+k*ncon, maxvwgt)))
+            continue;
+          if ((heavy ? adjwgt[j] : 0) > maxwgt || 
+              ((heavy ? adjwgt[j] : 0) == maxwgt && keys[k] > keys[maxidx])) {
+            maxidx = k;
+            maxwgt = (heavy ? adjwgt[j] : 0);
+          }
+        }
+        pref[i] = maxidx;
+      }
+    }
+
+    /* the vertices that point to each other are matched */
+    #pragma omp taskloop grainsize(1)
+    for (t=0; t<nchunks; t++) {
+      idx_t i, k, iend;
+
+      counts[t] = 0;
+      for (i=t*nvtxs/nchunks, iend=(t+1)*nvtxs/nchunks; i<iend; i++) {
+        if ((k = pref[i]) != -1 && pref[k] == i) {
+          match[i] = k;
+          counts[t]++;
+        }
+      }
+    }
+
+    nmatched = isum(nchunks, counts, 1);
+    IFSET(ctrl->dbglvl, METIS_DBG_COARSEN, 
+        printf("  round %"PRIDX": %"PRIDX" vertices matched\n", round, nmatched));
+    if (nmatched == 0)
+      break;
+  }
+
+  /* the unmatched island vertices are matched with any unmatched vertex, 
+     the others with themselves */
+  for (last_unmatched=0, i=0; i<nvtxs; i++) {
+    if (match[i] != UNMATCHED)
+      continue;
+
+    maxidx = i;
+    if (xadj[i] == xadj[i+1] && 
+        (ncon == 1 ? vwgt[i] < maxvwgt[0] : ivecle(ncon, vwgt+i*ncon, maxvwgt))) {
+      for (last_unmatched=gk_max(i, last_unmatched)+1; last_unmatched<nvtxs; last_unmatched++) {
+        if (match[last_unmatched] == UNMATCHED) {
+          maxidx = last_unmatched;
+          break;
+        }
+      }
+    }
+    match[i] = maxidx;
+    match[maxidx] = i;
+  }
+
+  /* number the coarse vertices in the order of their first vertex */
+  #pragma omp taskloop grainsize(1)
+  for (t=0; t<nchunks; t++) {
+    idx_t i, iend;
+
+    counts[t] = 0;
+    for (i=t*nvtxs/nchunks, iend=(t+1)*nvtxs/nchunks; i<iend; i++) {
+      if (i <= match[i])
+        counts[t]++;
+    }
+  }
+  for (cnvtxs=0, t=0; t<nchunks; t++) {
+    j = counts[t];
+    counts[t] = cnvtxs;
+    cnvtxs += j;
+  }
+
+  #pragma omp taskloop grainsize(1)
+  for (t=0; t<nchunks; t++) {
+    idx_t i, k, iend;
+
+    for (k=counts[t], i=t*nvtxs/nchunks, iend=(t+1)*nvtxs/nchunks; i<iend; i++) {
+      if (i <= match[i])
+        cmap[i] = cmap[match[i]] = k++;
+    }
+  }
+
+  IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->MatchTmr));
+
+  CreateCoarseGraphParallel(ctrl, graph, cnvtxs, match);
+
+  WCOREPOP;
+
+  return cnvtxs;
+}
+
+
 /*************************************************************************/
 /*! This function prints various stats for each graph during coarsening 
  */
@@ -951,6 +1298,146 @@ void CreateCoarseGraphPerm(ctrl_t *ctrl, graph_t *graph, idx_t cnvtxs,
 }
 
 
+/*************************************************************************/
+/*! This function creates the coarser graph with concurrent tasks, each 
+    one for a range of coarse vertices and with its own full-size htable. 
+    The tasks first count the adjacent coarse vertices of each coarse 
+    vertex, and then fill in the adjacency lists at the offsets given by 
+    the prefix sums of the counts. The coarse graph does not depend on the 
+    number of threads.
+ */
+/*************************************************************************/
+void CreateCoarseGraphParallel(ctrl_t *ctrl, graph_t *graph, idx_t cnvtxs, 
+         idx_t *match)
+{
+  idx_t i, t, nvtxs, ncon, nchunks, dovsize;
+  idx_t *xadj, *vwgt, *vsize, *adjncy, *adjwgt;
+  idx_t *cmap, *cvtxs, *htables;
+  idx_t *cxadj, *cvwgt, *cvsize, *cadjncy, *cadjwgt;
+  graph_t *cgraph;
+
+  WCOREPUSH;
+
+  dovsize = (ctrl->objtype == METIS_OBJTYPE_VOL ? 1 : 0);
+
+  IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_startcputimer(ctrl->ContractTmr));
+
+  nvtxs   = graph->nvtxs;
+  ncon    = graph->ncon;
+  xadj    = graph->xadj;
+  vwgt    = graph->vwgt;
+  vsize   = graph->vsize;
+  adjncy  = graph->adjncy;
+  adjwgt  = graph->adjwgt;
+  cmap    = graph->cmap;
+
+  nchunks = gk_max(1, ctrl->nthreads);
+
+  /* Initialize the coarser graph */
+  cgraph = SetupCoarseGraph(graph, cnvtxs, dovsize);
+  cxadj    = cgraph->xadj;
+  cvwgt    = cgraph->vwgt;
+  cvsize   = cgraph->vsize;
+  cadjncy  = cgraph->adjncy;
+  cadjwgt  = cgraph->adjwgt;
+
+  /* cvtxs[i] is the first vertex of coarse vertex i */
+  cvtxs   = iwspacemalloc(ctrl, cnvtxs);
+  htables = iwspacemalloc(ctrl, nchunks*cnvtxs);
+
+  #pragma omp taskloop grainsize(1)
+  for (t=0; t<nchunks; t++) {
+    idx_t v, vend;
+
+    for (v=t*nvtxs/nchunks, vend=(t+1)*nvtxs/nchunks; v<vend; v++) {
+      if (v <= match[v])
+        cvtxs[cmap[v]] = v;
+    }
+  }
+
+  /* count the adjacent coarse vertices, htable[k] == i if k has been seen */
+  #pragma omp taskloop grainsize(1)
+  for (t=0; t<nchunks; t++) {
+    idx_t i, ii, j, k, v, iend, *htable=htables+t*cnvtxs;
+
+    iset(cnvtxs, -1, htable);
+    for (i=t*cnvtxs/nchunks, iend=(t+1)*cnvtxs/nchunks; i<iend; i++) {
+      cxadj[i+1] = 0;
+      for (ii=0, v=cvtxs[i]; ii<2; ii++, v=match[v]) {
+        if (ii == 1 && v == match[v])
+          break;
+        for (j=xadj[v]; j<xadj[v+1]; j++) {
+          k = cmap[adjncy[j]];
+          if (k != i && htable[k] != i) {
+            htable[k] = i;
+            cxadj[i+1]++;
+          }
+        }
+      }
+    }
+  }
+
+  for (cxadj[0]=0, i=0; i<cnvtxs; i++)
+    cxadj[i+1] += cxadj[i];
+
+  /* fill in the adjacency lists, htable[k] is the position of k if it is 
+     in [cxadj[i], l) and cadjncy[htable[k]] == k */
+  #pragma omp taskloop grainsize(1)
+  for (t=0; t<nchunks; t++) {
+    idx_t i, ii, j, k, l, m, v, u, iend, *htable=htables+t*cnvtxs;
+
+    for (i=t*cnvtxs/nchunks, iend=(t+1)*cnvtxs/nchunks; i<iend; i++) {
+      v = cvtxs[i];
+      u = match[v];
+
+      if (ncon == 1)
+        cvwgt[i] = vwgt[v] + (v != u ? vwgt[u] : 0);
+      else {
+        icopy(ncon, vwgt+v*ncon, cvwgt+i*ncon);
+        if (v != u)
+          iaxpy(ncon, 1, vwgt+u*ncon, 1, cvwgt+i*ncon, 1);
+      }
+
+      if (dovsize)
+        cvsize[i] = vsize[v] + (v != u ? vsize[u] : 0);
+
+      for (l=cxadj[i], ii=0; ii<2; ii++, v=match[v]) {
+        if (ii == 1 && v == match[v])
+          break;
+        for (j=xadj[v]; j<xadj[v+1]; j++) {
+          k = cmap[adjncy[j]];
+          if (k == i)
+            continue;
+          m = htable[k];
+          if (m >= cxadj[i] && m < l && cadjncy[m] == k) {
+            cadjwgt[m] += adjwgt[j];
+          }
+          else {
+            htable[k]  = l;
+            cadjncy[l] = k;
+            cadjwgt[l++] = adjwgt[j];
+          }
+        }
+      }
+      ASSERT(l == cxadj[i+1]);
+    }
+  }
+
+  cgraph->nedges = cxadj[cnvtxs];
+
+  for (i=0; i<ncon; i++) {
+    cgraph->tvwgt[i]    = isum(cgraph->nvtxs, cgraph->vwgt+i, ncon);
+    cgraph->invtvwgt[i] = 1.0/(cgraph->tvwgt[i] > 0 ? cgraph->tvwgt[i] : 1);
+  }
+
+  ReAdjustMemory(ctrl, graph, cgraph);
+
+  IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->ContractTmr));
+
+  WCOREPOP;
+}
+
+
 /*************************************************************************/
 /*! Setup the various arrays for the coarse graph 
  */
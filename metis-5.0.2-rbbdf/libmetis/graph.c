@@ -132,6 +132,8 @@ bigraph_t* SetupBiGraphFromGraph(graph_t *graph, idx_t nrows, idx_t ncols,
 	bigraph->ncols = ncols;
 	bigraph->area = nrows * ncols;
 	bigraph->nz = graph->nedges / 2;
+	bigraph->snz = bigraph->nz;
+	bigraph->sarea = bigraph->area;
 	bigraph->partible = 1;
 
 	bigraph->rlabel = rlabel;
@@ -161,8 +163,9 @@ bigraph_t* SetupBiGraphFromGraph(graph_t *graph, idx_t nrows, idx_t ncols,
 	bigraph->clabel->ref = 1;
 	*/
 
-	bigraph->right = NULL;
-	bigraph->down = NULL;
+	bigraph->nbrds = 0;
+	bigraph->brds = NULL;
+	bigraph->bnz = NULL;
 	bigraph->next = NULL;
 
 	return bigraph;
@@ -257,23 +260,6 @@ bigraph_t *CreateBiGraph(void){
 	return bigraph;
 }
 
-bigraph_t *CreateBorder(idx_t nrows, idx_t ncols, idx_t nz, label_t *rlabel, label_t *clabel) {
-	bigraph_t *border;
-
-	border = CreateBiGraph();
-	border->nrows = nrows;
-	border->ncols = ncols;
-	border->nz = nz;
-	border->area = nrows * ncols;
-	border->rlabel = rlabel;
-	border->clabel = clabel;
-	border->rlabel->ref++;
-	border->clabel->ref++;
-	border->partible = 1;
-
-	return border;
-}
-
 /*************************************************************************/
 /*! This function initializes a graph_t data structure */
 /*************************************************************************/
@@ -322,6 +308,8 @@ void InitGraph(graph_t *graph)
   /* linked-list structure */
   graph->coarser   = NULL;
   graph->finer     = NULL;
+
+  graph->chier     = NULL;
 }
 
 void InitBiGraph(bigraph_t *bigraph){
@@ -332,11 +320,19 @@ void InitBiGraph(bigraph_t *bigraph){
 	bigraph->nrows = -1;
 	bigraph->area = -1;
 	bigraph->nz = -1;
+	bigraph->snz = -1;
+	bigraph->sarea = -1;
 	bigraph->partible = 1;
+	bigraph->bisect = 0;
+	bigraph->cwhere = NULL;
+	bigraph->csnz = -1;
+	bigraph->csarea = -1;
+	bigraph->carea = -1;
 	bigraph->rlabel = NULL;
 	bigraph->clabel= NULL;
-	bigraph->right = NULL;
-	bigraph->down = NULL;
+	bigraph->nbrds = 0;
+	bigraph->brds = NULL;
+	bigraph->bnz = NULL;
 	bigraph->next = NULL;
 }
 
@@ -387,6 +383,8 @@ void FreeGraph(graph_t **r_graph)
   /* free partition/refinement structure */
   FreeRData(graph);
 
+  FreeCHier(&graph->chier);
+
   gk_free((void **)&graph->tvwgt, &graph->invtvwgt, &graph->label, 
       &graph->cmap, &graph, LTERM);
 
@@ -394,19 +392,91 @@ void FreeGraph(graph_t **r_graph)
 }
 
 
+/*************************************************************************/
+/*! This function creates a coarsening hierarchy of nlevels levels, with 
+    room for ncmap entries in its cmaps */
+/*************************************************************************/
+chier_t *CreateCHier(idx_t nlevels, idx_t ncmap)
+{
+  chier_t *chier;
+
+  chier = (chier_t *)gk_malloc(sizeof(chier_t), "CreateCHier: chier");
+
+  chier->nlevels = nlevels;
+  chier->nvtxs   = imalloc(2*nlevels+1, "CreateCHier: nvtxs");
+  chier->ptr     = chier->nvtxs + nlevels + 1;
+  chier->cmap    = imalloc(ncmap, "CreateCHier: cmap");
+
+  return chier;
+}
+
+
+/*************************************************************************/
+/*! This function returns a copy of a coarsening hierarchy, or NULL */
+/*************************************************************************/
+chier_t *CopyCHier(chier_t *chier)
+{
+  idx_t ncmap;
+  chier_t *nchier;
+
+  if (chier == NULL)
+    return NULL;
+
+  ncmap  = chier->ptr[chier->nlevels-1] + chier->nvtxs[chier->nlevels-1];
+  nchier = CreateCHier(chier->nlevels, ncmap);
+
+  icopy(chier->nlevels+1, chier->nvtxs, nchier->nvtxs);
+  icopy(chier->nlevels, chier->ptr, nchier->ptr);
+  icopy(ncmap, chier->cmap, nchier->cmap);
+
+  return nchier;
+}
+
+
+/*************************************************************************/
+/*! This function frees a coarsening hierarchy */
+/*************************************************************************/
+void FreeCHier(chier_t **r_chier)
+{
+  chier_t *chier = *r_chier;
+
+  if (chier == NULL)
+    return;
+
+  gk_free((void **)&chier->nvtxs, &chier->cmap, r_chier, LTERM);
+}
+
+
 /*******************************************************************************
  * This function frees a bipartite graph.
- * This function CAN ONLY be used by FreeBigraphBorder.
+ * The border groups it uses are released once no other bigraph uses them.
  *******************************************************************************/
 void FreeBiGraph(ctrl_t *ctrl, bigraph_t **r_bigraph){
 	bigraph_t *bigraph = *r_bigraph;
+	border_t *border;
+	idx_t t;
 
 	if (ctrl == NULL || bigraph == NULL)
 		return;
 
+	gk_free((void**)&bigraph->cwhere, LTERM);
+
 	if (bigraph == ctrl->obigraph)
 		return;
 
+	/* release the border groups that are no longer used by any bigraph */
+	for (t = 0; t < bigraph->nbrds; t++) {
+		border = ctrl->borders + bigraph->brds[t];
+		if (--border->ref == 0)
+			gk_free((void**)&border->rlabel, &border->clabel, LTERM);
+	}
+	/* the borders of rejected bisections are released right after they were
+	 * added, so their entries are taken back from the end of the table */
+	while (ctrl->nborders > 0 && ctrl->borders[ctrl->nborders-1].ref == 0)
+		ctrl->nborders--;
+	gk_free((void**)&bigraph->brds, LTERM);
+	bigraph->bnz = NULL;
+
 	if (bigraph->super)	FreeGraph(&bigraph->super);
 
 	if (bigraph->rlabel){
@@ -420,47 +490,9 @@ void FreeBiGraph(ctrl_t *ctrl, bigraph_t **r_bigraph){
 		bigraph->clabel = NULL;
 	}
 
-	/* Note: we just ignore the free of pointers right, down and next here */
+	/* Note: we just ignore the free of pointer next here */
 
 	gk_free((void**)r_bigraph, LTERM);	/* TODO */
 	*r_bigraph = NULL;
 }
 
-/*******************************************************************************
- * This function frees a block diagonal as well as the borders realated to it.
- * This function can be used outside.
- *******************************************************************************/
-void FreeBiGraphBorder(ctrl_t *ctrl, bigraph_t **r_biborder) {
-	bigraph_t *p, *q, *r = *r_biborder;
-
-	while (r) {
-		p = r;
-		while (p) {
-			q = p->right;
-			FreeBiGraph(ctrl, &p);
-			p = q;
-		}
-		r = r->down;
-	}
-	*r_biborder = NULL;
-}
-
-void FreeBiGraphBorderList(ctrl_t *ctrl, bigraph_t **r_biborderlist, idx_t ndiags){
-	bigraph_t *p = *r_biborderlist, *q;
-	idx_t i = 0;
-
-	if(p == NULL)	return;
-
-	printf("%d diagonal block to free.\n", ndiags);
-
-	while(p){
-		i++;
-		printf("freeing D%d\r", i);
-		q = p->next;
-		FreeBiGraphBorder(ctrl, &p);
-		p = q;
-	}
-	printf("\n");
-
-	*r_biborderlist = NULL;
-}
@@ -41,10 +41,11 @@
 **************************************************************************/
 void MinCover(idx_t *xadj, idx_t *adjncy, idx_t asize, idx_t bsize, idx_t *cover, idx_t *csize)
 {
-  idx_t i, j;
+  idx_t i, j, k;
   idx_t *mate, *queue, *flag, *level, *lst;
   idx_t fptr, rptr, lstptr;
   idx_t row, maxlevel, col;
+  ikv_t *cand;
 
   mate = ismalloc(bsize, -1, "MinCover: mate");
   flag = imalloc(bsize, "MinCover: flag");
@@ -52,16 +53,29 @@ void MinCover(idx_t *xadj, idx_t *adjncy, idx_t asize, idx_t bsize, idx_t *cover
   queue = imalloc(bsize, "MinCover: queue");
   lst = imalloc(bsize, "MinCover: lst");
 
-  /* Get a cheap matching */
+  /* Get a cheap matching, from the A vertices of the lowest degree on, 
+     each with its free B vertex of the lowest degree. This leaves far 
+     fewer free vertices, and so BFS/DFS rounds, than taking the first 
+     free B vertex of each A vertex */
+  cand = ikvmalloc(asize, "MinCover: cand");
   for (i=0; i<asize; i++) {
-    for (j=xadj[i]; j<xadj[i+1]; j++) {
-      if (mate[adjncy[j]] == -1) {
-        mate[i] = adjncy[j];
-        mate[adjncy[j]] = i;
-        break;
-      }
+    cand[i].key = xadj[i+1]-xadj[i];
+    cand[i].val = i;
+  }
+  ikvsorti(asize, cand);
+  for (k=0; k<asize; k++) {
+    i = cand[k].val;
+    for (col=-1, j=xadj[i]; j<xadj[i+1]; j++) {
+      if (mate[adjncy[j]] == -1 && (col == -1 || 
+            xadj[adjncy[j]+1]-xadj[adjncy[j]] < xadj[col+1]-xadj[col]))
+        col = adjncy[j];
+    }
+    if (col != -1) {
+      mate[i] = col;
+      mate[col] = i;
     }
   }
+  gk_free((void **)&cand, LTERM);
 
   /* Get into the main loop */
   while (1) {
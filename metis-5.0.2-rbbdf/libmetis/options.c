@@ -95,8 +95,13 @@ ctrl_t *SetupCtrl(moptype_et optype, idx_t *options, idx_t ncon, idx_t nparts,
 	  ctrl->density /= DIVIDER;
 	  ctrl->nrows    = GETOPTION(options, METIS_OPTION_NROWS, -1);
 	  ctrl->ncols    = GETOPTION(options, METIS_OPTION_NCOLS, -1);
-	  ctrl->kappa    = GETOPTION(options, METIS_OPTION_KAPPA, 1);
+	  ctrl->kappa    = GETOPTION(options, METIS_OPTION_KAPPA, 2);
+	  if (ctrl->kappa == 1)	/* a split yields at least two blocks */
+		ctrl->kappa = 2;
 	  ctrl->ndiags   = GETOPTION(options, METIS_OPTION_NDIAGS, -1);
+	  ctrl->nthreads = GETOPTION(options, METIS_OPTION_NTHREADS, 1);
+	  ctrl->select   = GETOPTION(options, METIS_OPTION_SELECT, METIS_SELECT_FIRST);
+	  ctrl->inherit  = GETOPTION(options, METIS_OPTION_INHERIT, 0);
 
 	  /*Inner parameters*/
       ctrl->ufactor  = GETOPTION(options, METIS_OPTION_UFACTOR,  OMETIS_DEFAULT_UFACTOR);	/*TODO*/
@@ -232,6 +237,9 @@ void PrintCtrl(ctrl_t *ctrl)
     case METIS_CTYPE_SHEM:
       printf("METIS_CTYPE_SHEM\n");
       break;
+    case METIS_CTYPE_PHEM:
+      printf("METIS_CTYPE_PHEM\n");
+      break;
     default:
       printf("Unknown!\n");
   }
@@ -271,6 +279,9 @@ void PrintCtrl(ctrl_t *ctrl)
     case METIS_RTYPE_SEP1SIDED:
       printf("METIS_RTYPE_SEP1SIDED\n");
       break;
+    case METIS_RTYPE_SEPDENSE:
+      printf("METIS_RTYPE_SEPDENSE\n");
+      break;
     default:
       printf("Unknown!\n");
   }
@@ -332,7 +343,8 @@ int CheckParams(ctrl_t *ctrl)
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect objective type.\n"));
         return 0;
       }
-      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM) {
+      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM && 
+          ctrl->ctype != METIS_CTYPE_PHEM) {
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect coarsening scheme.\n"));
         return 0;
       }
@@ -402,7 +414,8 @@ int CheckParams(ctrl_t *ctrl)
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect objective type.\n"));
         return 0;
       }
-      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM) {
+      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM && 
+          ctrl->ctype != METIS_CTYPE_PHEM) {
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect coarsening scheme.\n"));
         return 0;
       }
@@ -481,7 +494,8 @@ int CheckParams(ctrl_t *ctrl)
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect objective type.\n"));
         return 0;
       }
-      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM) {
+      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM && 
+          ctrl->ctype != METIS_CTYPE_PHEM) {
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect coarsening scheme.\n"));
         return 0;
       }
@@ -545,7 +559,8 @@ int CheckParams(ctrl_t *ctrl)
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect objective type.\n"));
         return 0;
       }
-      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM) {
+      if (ctrl->ctype != METIS_CTYPE_RM && ctrl->ctype != METIS_CTYPE_SHEM && 
+          ctrl->ctype != METIS_CTYPE_PHEM) {
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect coarsening scheme.\n"));
         return 0;
       }
@@ -553,7 +568,8 @@ int CheckParams(ctrl_t *ctrl)
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect initial partitioning scheme.\n"));
         return 0;
       }
-      if (ctrl->rtype != METIS_RTYPE_SEP1SIDED && ctrl->rtype != METIS_RTYPE_SEP2SIDED) {
+      if (ctrl->rtype != METIS_RTYPE_SEP1SIDED && ctrl->rtype != METIS_RTYPE_SEP2SIDED &&
+          ctrl->rtype != METIS_RTYPE_SEPDENSE) {
         IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect refinement scheme.\n"));
         return 0;
       }
@@ -623,6 +639,15 @@ int CheckParams(ctrl_t *ctrl)
 		  IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect ndiags.\n"));
 		  return 0;
 	  }
+	  if(ctrl->nthreads <= 0){
+		  IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect nthreads.\n"));
+		  return 0;
+	  }
+	  if(ctrl->select != METIS_SELECT_FIRST && ctrl->select != METIS_SELECT_BEST
+			  && ctrl->select != METIS_SELECT_RATIO){
+		  IFSET(dbglvl, METIS_DBG_INFO, printf("Input Error: Incorrect select.\n"));
+		  return 0;
+	  }
 
       break;
 
@@ -651,3 +676,48 @@ void FreeCtrl(ctrl_t **r_ctrl)
 }
 
 
+/*************************************************************************/
+/*! This function creates a private copy of ctrl for a worker thread that
+    bisects graph. The copy shares the read-only parameters of ctrl, but 
+    gets its own workspace and its own copies of the arrays that are 
+    written during a bisection (maxvwgt, pijbm). */
+/*************************************************************************/
+ctrl_t *SetupWorkerCtrl(ctrl_t *ctrl, graph_t *graph)
+{
+  ctrl_t *wctrl;
+
+  wctrl = (ctrl_t *)gk_malloc(sizeof(ctrl_t), "SetupWorkerCtrl: wctrl");
+  memcpy((void *)wctrl, (void *)ctrl, sizeof(ctrl_t));
+
+  wctrl->maxvwgt = ismalloc(ctrl->ncon, 0, "SetupWorkerCtrl: maxvwgt");
+  wctrl->pijbm   = rmalloc(ctrl->nparts*ctrl->ncon, "SetupWorkerCtrl: pijbm");
+
+  wctrl->mcore    = NULL;
+  wctrl->cnbrpool = NULL;
+  wctrl->vnbrpool = NULL;
+  wctrl->bndmark  = NULL;
+  wctrl->borders  = NULL;
+  wctrl->nborders = wctrl->maxborders = 0;
+
+  AllocateWorkSpace(wctrl, graph);
+
+  return wctrl;
+}
+
+
+/*************************************************************************/
+/*! This function frees a ctrl created by SetupWorkerCtrl(). tpwgts and
+    ubfactors belong to the parent ctrl and are left untouched. */
+/*************************************************************************/
+void FreeWorkerCtrl(ctrl_t **r_wctrl)
+{
+  ctrl_t *wctrl = *r_wctrl;
+
+  FreeWorkSpace(wctrl);
+
+  gk_free((void **)&wctrl->pijbm, &wctrl->maxvwgt, &wctrl, LTERM);
+
+  *r_wctrl = NULL;
+}
+
+
@@ -41,8 +41,12 @@ int CheckBiGraph(bigraph_t *bigraph, int numflag, int verbose);
 /* coarsen.c */
 graph_t *CoarsenGraph(ctrl_t *ctrl, graph_t *graph);
 graph_t *CoarsenGraphNlevels(ctrl_t *ctrl, graph_t *graph, idx_t nlevels);
+graph_t *CoarsenGraphInherit(ctrl_t *ctrl, graph_t *graph, idx_t nlevels);
+chier_t *SetupCHier(graph_t *graph, graph_t *cgraph);
+chier_t *RestrictCHier(ctrl_t *ctrl, chier_t *chier, idx_t *where, idx_t part);
 idx_t Match_RM(ctrl_t *ctrl, graph_t *graph);
 idx_t Match_SHEM(ctrl_t *ctrl, graph_t *graph);
+idx_t Match_PHEM(ctrl_t *ctrl, graph_t *graph, idx_t heavy);
 void PrintCGraphStats(ctrl_t *ctrl, graph_t *graph);
 void CreateCoarseGraph(ctrl_t *ctrl, graph_t *graph, idx_t cnvtxs, 
          idx_t *match);
@@ -50,6 +54,8 @@ void CreateCoarseGraphNoMask(ctrl_t *ctrl, graph_t *graph, idx_t cnvtxs,
          idx_t *match);
 void CreateCoarseGraphPerm(ctrl_t *ctrl, graph_t *graph, idx_t cnvtxs, 
          idx_t *match, idx_t *perm);
+void CreateCoarseGraphParallel(ctrl_t *ctrl, graph_t *graph, idx_t cnvtxs, 
+         idx_t *match);
 graph_t *SetupCoarseGraph(graph_t *graph, idx_t cnvtxs, idx_t dovsize);
 void ReAdjustMemory(ctrl_t *ctrl, graph_t *graph, graph_t *cgraph);
 
@@ -58,6 +64,8 @@ void ReAdjustMemory(ctrl_t *ctrl, graph_t *graph, graph_t *cgraph);
 /* compress.c */
 graph_t *CompressGraph(ctrl_t *ctrl, idx_t nvtxs, idx_t *xadj, idx_t *adjncy, 
              idx_t *vwgt, idx_t *cptr, idx_t *cind);
+graph_t *CompressBiGraph(ctrl_t *ctrl, graph_t *graph, idx_t nrows, 
+             idx_t *cptr, idx_t *cind);
 graph_t *PruneGraph(ctrl_t *ctrl, idx_t nvtxs, idx_t *xadj, idx_t *adjncy, 
              idx_t *vwgt, idx_t *iperm, real_t factor);
 
@@ -123,12 +131,12 @@ void InitGraph(graph_t *graph);
 void FreeRData(graph_t *graph);
 void FreeGraph(graph_t **graph);
 /*evison*/
+chier_t *CreateCHier(idx_t nlevels, idx_t ncmap);
+chier_t *CopyCHier(chier_t *chier);
+void FreeCHier(chier_t **r_chier);
 bigraph_t *CreateBiGraph(void);
-bigraph_t *CreateBorder(idx_t nrows, idx_t ncols, idx_t nz, label_t *rlabel, label_t *clabel);
 void InitBiGraph(bigraph_t *bigraph);
 void FreeBiGraph(ctrl_t *ctrl, bigraph_t **r_bigraph);
-void FreeBiGraphBorder(ctrl_t *ctrl, bigraph_t **r_biborder);
-void FreeBiGraphBorderList(ctrl_t *ctrl, bigraph_t **r_biborderlist, idx_t ndiags);
 bigraph_t* SetupBiGraphFromParams(ctrl_t *ctrl, idx_t nvtxs, idx_t ncon, idx_t *xadj,
              idx_t *adjncy, idx_t *vwgt, idx_t *vsize, idx_t *adjwgt,
              idx_t nrows, idx_t ncols, idx_t totalnrows, idx_t totalncols,
@@ -266,11 +274,12 @@ void MMDOrder(ctrl_t *ctrl, graph_t *graph, idx_t *order, idx_t lastvtx);
 /* bmetis.c */ /* evison */
 //void InitDiags(bigraph_t *bigraph, idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *ndiags);
 void MlevelNestedBDFCC(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *order, idx_t ndiags,
-		idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags);
+		bdfdiags_t **r_diags);
+bigraph_t *SetupBiGraphFromComponent(ctrl_t *ctrl, graph_t *graph);
 void MlevelNestedBDF(ctrl_t *ctrl, bigraph_t *head, idx_t *order, idx_t ndiags,
-		idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags);
+		bdfdiags_t **r_diags);
 void MlevelNodeBisectionMultipleBDF(ctrl_t *ctrl, graph_t *graph);
-real_t AverageDensity(bigraph_t *head);
+real_t AverageDensity(ctrl_t *ctrl);
 real_t Density(bigraph_t *bigraph);
 idx_t Area(bigraph_t *bigraph);
 void SortBlockDiagsByDense(bigraph_t *head, idx_t ndiags, bigraph_t** sort, real_t* denses);
@@ -278,23 +287,44 @@ void QSortBlockDiagsByDense(bigraph_t** sort, real_t* denses, idx_t l, idx_t r);
 void SortBlockDiagsByArea(bigraph_t *head, idx_t ndiags, bigraph_t** sort, idx_t* areas);
 void SortBlockDiagsBySingleArea(bigraph_t *head, idx_t ndiags, bigraph_t **sort, idx_t *areas);
 void QSortBlockDiagsByArea(bigraph_t** sort, idx_t *areas, idx_t l, idx_t r);
-void SplitGraphOrderBDF(ctrl_t *ctrl, graph_t *graph, graph_t **r_lgraph, graph_t **r_rgraph);
+void BlockQueueInsert(ikv_t *heap, idx_t *r_nnodes, idx_t id, idx_t area);
+idx_t BlockQueueGetTop(ikv_t *heap, idx_t *r_nnodes);
+void SplitGraphOrderBDF(ctrl_t *ctrl, graph_t *graph, graph_t **sgraphs);
 void SplitGraphOrderUncompressBDF(ctrl_t *ctrl, graph_t *graph, graph_t *cgraph, idx_t *cptr, idx_t *cind,
-		graph_t **r_lgraph, graph_t **r_rgraph);
-void ExtractBiGraph(ctrl_t *ctrl, bigraph_t *bigraph, graph_t *lgraph, graph_t *rgraph,
-		bigraph_t **r_lbigraph, bigraph_t **r_rbigraph);
+		graph_t **sgraphs);
+void ExtractBiGraph(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, graph_t **sgraphs,
+		bigraph_t **children);
 void MlevelNodeBisectionBDFL2(ctrl_t *ctrl, graph_t *graph, idx_t niparts);
+void MlevelNodeBisectionTrialsBDF(ctrl_t *ctrl, graph_t *graph, idx_t ntrials,
+		idx_t level, idx_t niparts);
 void MlevelNodeBisectionBDFL1(ctrl_t *ctrl, graph_t *graph, idx_t niparts);
-real_t AverageReplaceDensity(bigraph_t *head, bigraph_t *old, bigraph_t *new1, bigraph_t *new2);
-void ConstructResult(bigraph_t *head, idx_t ndiags, idx_t ***r_rdiags, idx_t ***r_cdiags, idx_t *r_ndiags);
-void StatNzAndArea(bigraph_t *bigraph, idx_t *r_snz, idx_t *r_sarea, idx_t islist);
-idx_t StatNonZeros(ctrl_t *ctrl, label_t *rlabel, label_t *clabel, idx_t nrows, idx_t ncols);
+real_t AverageReplaceDensity(ctrl_t *ctrl, bigraph_t *old, idx_t nsnz, idx_t nsarea);
+bdfdiags_t *ConstructResult(ctrl_t *ctrl, bigraph_t *head, idx_t ndiags);
+void StatNzAndArea(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *r_snz, idx_t *r_sarea, idx_t islist);
+idx_t AddBorder(ctrl_t *ctrl, idx_t nrows, idx_t ncols, idx_t *rlabel, idx_t *clabel);
+void StatBorderNonZeros(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, idx_t **rlabels,
+		idx_t **clabels, idx_t *nrows, idx_t *ncols, idx_t *bnz, idx_t *rnz);
 void OrderEachGraph(bigraph_t *head, idx_t *order);
 idx_t CheckPermIPerm(idx_t *perm, idx_t *iperm, idx_t nvtxs);
-int CheckNonZeros(bigraph_t *bigraph, bigraph_t *lbigraph, bigraph_t *rbigraph);
+int CheckNonZeros(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, bigraph_t **children);
 void PrintSortedList(idx_t ndiags, bigraph_t **sort, idx_t *areas, real_t *denses, idx_t isarea);
-idx_t CheckArea(bigraph_t *bigraph, bigraph_t *lbigraph, bigraph_t *rbigraph);
-void StatNrowsAndNcols(bigraph_t *bigraph, idx_t *r_nrows, idx_t *r_ncols);
+idx_t CheckArea(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, bigraph_t **children);
+void StatNrowsAndNcols(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *r_nrows, idx_t *r_ncols);
+void SetupDensityBorders(ctrl_t *ctrl, bigraph_t *bigraph, ctrl_t *bctrl);
+void BisectBlockDiag(ctrl_t *ctrl, bigraph_t *bigraph, graph_t **sgraphs);
+void MlevelKWayNodeSeparatorBDF(ctrl_t *ctrl, graph_t *graph, idx_t nparts, idx_t seed);
+void KWayEdgePartitionBDF(ctrl_t *ctrl, graph_t *graph, idx_t nparts, idx_t seed, idx_t *where);
+void CoverCutEdgesBDF(ctrl_t *ctrl, graph_t *graph, idx_t *where, idx_t sep);
+void SelectKWayNodeSeparatorBDF(ctrl_t *ctrl, bigraph_t *bigraph, graph_t *graph,
+		idx_t *cptr, idx_t *cind, idx_t seed);
+idx_t SeparatorNzAndArea(ctrl_t *ctrl, bigraph_t *bigraph, idx_t *where,
+		idx_t *r_nsnz, idx_t *r_nsarea);
+void SplitCachedBisection(ctrl_t *ctrl, bigraph_t *bigraph, graph_t **sgraphs);
+void CacheBisection(ctrl_t *ctrl, bigraph_t *bigraph, idx_t nparts, bigraph_t **children,
+		idx_t nsnz, idx_t nsarea, idx_t narea);
+void SetupSeparatorFromWhere(ctrl_t *ctrl, graph_t *graph);
+idx_t RemoveEmptyGraphs(idx_t n, graph_t **graphs);
+void BisectBlockDiagsP(ctrl_t *ctrl, idx_t ncands, bigraph_t **cands, graph_t **sgraphs);
 
 /* options.c */
 ctrl_t *SetupCtrl(moptype_et optype, idx_t *options, idx_t ncon, idx_t nparts, 
@@ -304,6 +334,8 @@ void Setup2WayBalMultipliers(ctrl_t *ctrl, graph_t *graph, real_t *tpwgts);
 void PrintCtrl(ctrl_t *ctrl);
 int CheckParams(ctrl_t *ctrl);
 void FreeCtrl(ctrl_t **r_ctrl);
+ctrl_t *SetupWorkerCtrl(ctrl_t *ctrl, graph_t *graph);
+void FreeWorkerCtrl(ctrl_t **r_wctrl);
 
 
 /* parmetis.c */
@@ -337,11 +369,18 @@ void ConstructMinCoverSeparator(ctrl_t *ctrl, graph_t *graph);
 /* sfm.c */
 void FM_2WayNodeRefine2Sided(ctrl_t *ctrl, graph_t *graph, idx_t niter);
 void FM_2WayNodeRefine1Sided(ctrl_t *ctrl, graph_t *graph, idx_t niter);
+void FM_2WayNodeRefineDensity(ctrl_t *ctrl, graph_t *graph, idx_t niter, 
+         idx_t *rwgt, idx_t *inz);
+real_t NodeDensity(ctrl_t *ctrl, idx_t *rows, idx_t *cols, idx_t nz);
+real_t NodeDensityGain(idx_t rmove, idx_t cmove, idx_t rpull, idx_t cpull, 
+         idx_t snz, idx_t *dims, real_t density);
 void FM_2WayNodeBalance(ctrl_t *ctrl, graph_t *graph);
 
 
 /* srefine.c */
 void Refine2WayNode(ctrl_t *ctrl, graph_t *orggraph, graph_t *graph);
+idx_t Setup2WayNodeDensityInfo(ctrl_t *ctrl, graph_t *orggraph, graph_t *graph,
+          idx_t ***r_rwgts, idx_t ***r_inzs);
 void Allocate2WayNodePartitionMemory(ctrl_t *ctrl, graph_t *graph);
 void Compute2WayNodePartitionParams(ctrl_t *ctrl, graph_t *graph);
 void Project2WayNodePartition(ctrl_t *ctrl, graph_t *graph);
@@ -35,17 +35,23 @@
 
 /* coarsen.c */
 #define CoarsenGraph			libmetis__CoarsenGraph
+#define CoarsenGraphInherit		libmetis__CoarsenGraphInherit
+#define SetupCHier			libmetis__SetupCHier
+#define RestrictCHier			libmetis__RestrictCHier
 #define Match_RM                        libmetis__Match_RM
 #define Match_SHEM                      libmetis__Match_SHEM
+#define Match_PHEM                      libmetis__Match_PHEM
 #define PrintCGraphStats                libmetis__PrintCGraphStats
 #define CreateCoarseGraph		libmetis__CreateCoarseGraph
 #define CreateCoarseGraphNoMask		libmetis__CreateCoarseGraphNoMask
 #define CreateCoarseGraphPerm		libmetis__CreateCoarseGraphPerm
+#define CreateCoarseGraphParallel	libmetis__CreateCoarseGraphParallel
 #define SetupCoarseGraph		libmetis__SetupCoarseGraph
 #define ReAdjustMemory			libmetis__ReAdjustMemory
 
 /* compress.c */
 #define CompressGraph			libmetis__CompressGraph
+#define CompressBiGraph			libmetis__CompressBiGraph
 #define PruneGraph			libmetis__PruneGraph
 
 /* contig.c */
@@ -96,12 +102,12 @@
 #define FreeRData                       libmetis__FreeRData
 #define FreeGraph                       libmetis__FreeGraph
 /*evison*/
+#define CreateCHier					libmetis__CreateCHier
+#define CopyCHier					libmetis__CopyCHier
+#define FreeCHier					libmetis__FreeCHier
 #define CreateBiGraph					libmetis__CreateBiGraph
-#define CreateBorder					libmetis__CreateBorder
 #define InitBiGraph						libmetis__InitBiGraph
 #define FreeBiGraph						libmetis__FreeBiGraph
-#define FreeBiGraphBorder				libmetis__FreeBiGraphBorder
-#define FreeBiGraphBorderList			libmetis__FreeBiGraphBorderList
 #define SetupBiGraphFromParams			libmetis__SetupBiGraphFromParams
 #define SetupBiGraphFromGraph			libmetis__SetupBiGraphFromGraph
 
@@ -201,6 +207,7 @@
 /* bmetis.c */ /* evison */
 //#define InitDiags					libmetis__InitDiags
 #define MlevelNestedBDFCC			libmetis__MlevelNestedBDFCC
+#define SetupBiGraphFromComponent	libmetis__SetupBiGraphFromComponent
 #define MlevelNestedBDF				libmetis__MlevelNestedBDF
 #define AverageDensity				libmetis__AverageDensity
 #define Density						libmetis__Density
@@ -209,23 +216,39 @@
 #define QSortBlockDiagsByDense		libmetis__QSortBlockDiagsByDense
 #define SortBlockDiagsByArea		libmetis__SortBlockDiagsByArea
 #define QSortBlockDiagsByArea		libmetis__QSortBlockDiagsByArea
+#define BlockQueueInsert			libmetis__BlockQueueInsert
+#define BlockQueueGetTop			libmetis__BlockQueueGetTop
 #define SortBlockDiagsBySingleArea	libmetis__SortBlockDiagsBySingleArea
 #define MlevelNodeBisectionMultipleBDF	libmetis__MlevelNodeBisectionMultipleBDF
 #define SplitGraphOrderBDF				libmetis__SplitGraphOrderBDF
 #define SplitGraphOrderUncompressBDF	libmetis__SplitGraphOrderUncompressBDF
 #define ExtractBiGraph				libmetis__ExtractBiGraph
 #define MlevelNodeBisectionBDFL2	libmetis__MlevelNodeBisectionBDFL2
+#define MlevelNodeBisectionTrialsBDF	libmetis__MlevelNodeBisectionTrialsBDF
 #define MlevelNodeBisectionBDFL1	libmetis__MlevelNodeBisectionBDFL1
 #define AverageReplaceDensity		libmetis__AverageReplaceDensity
 #define ConstructResult				libmetis__ConstructResult
 #define StatNzAndArea				libmetis__StatNzAndArea
-#define StatNonZeros				libmetis__StatNonZeros
+#define AddBorder					libmetis__AddBorder
+#define StatBorderNonZeros			libmetis__StatBorderNonZeros
 #define OrderEachGraph				libmetis__OrderEachGraph
 #define CheckPermIPerm				libmetis__CheckPermIPerm
 #define CheckNonZeros				libmetis__CheckNonZeros
 #define PrintSortedList				libmetis__PrintSortedList
 #define CheckArea					libmetis__CheckArea
 #define StatNrowsAndNcols			libmetis__StatNrowsAndNcols
+#define SetupDensityBorders		libmetis__SetupDensityBorders
+#define BisectBlockDiag				libmetis__BisectBlockDiag
+#define MlevelKWayNodeSeparatorBDF	libmetis__MlevelKWayNodeSeparatorBDF
+#define KWayEdgePartitionBDF		libmetis__KWayEdgePartitionBDF
+#define CoverCutEdgesBDF			libmetis__CoverCutEdgesBDF
+#define SelectKWayNodeSeparatorBDF	libmetis__SelectKWayNodeSeparatorBDF
+#define SeparatorNzAndArea			libmetis__SeparatorNzAndArea
+#define SplitCachedBisection		libmetis__SplitCachedBisection
+#define CacheBisection				libmetis__CacheBisection
+#define SetupSeparatorFromWhere		libmetis__SetupSeparatorFromWhere
+#define RemoveEmptyGraphs			libmetis__RemoveEmptyGraphs
+#define BisectBlockDiagsP			libmetis__BisectBlockDiagsP
 
 /* options.c */
 #define SetupCtrl                       libmetis__SetupCtrl
@@ -233,6 +256,8 @@
 #define Setup2WayBalMultipliers         libmetis__Setup2WayBalMultipliers
 #define PrintCtrl                       libmetis__PrintCtrl
 #define FreeCtrl                        libmetis__FreeCtrl
+#define SetupWorkerCtrl                 libmetis__SetupWorkerCtrl
+#define FreeWorkerCtrl                  libmetis__FreeWorkerCtrl
 #define CheckParams                     libmetis__CheckParams
 
 /* parmetis.c */
@@ -258,10 +283,14 @@
 /* sfm.c */
 #define FM_2WayNodeRefine2Sided         libmetis__FM_2WayNodeRefine2Sided 
 #define FM_2WayNodeRefine1Sided         libmetis__FM_2WayNodeRefine1Sided
+#define FM_2WayNodeRefineDensity        libmetis__FM_2WayNodeRefineDensity
+#define NodeDensity                     libmetis__NodeDensity
+#define NodeDensityGain                 libmetis__NodeDensityGain
 #define FM_2WayNodeBalance              libmetis__FM_2WayNodeBalance
 
 /* srefine.c */
 #define Refine2WayNode			libmetis__Refine2WayNode
+#define Setup2WayNodeDensityInfo	libmetis__Setup2WayNodeDensityInfo
 #define Allocate2WayNodePartitionMemory	libmetis__Allocate2WayNodePartitionMemory
 #define Compute2WayNodePartitionParams	libmetis__Compute2WayNodePartitionParams
 #define Project2WayNodePartition	libmetis__Project2WayNodePartition
@@ -469,6 +469,338 @@ void FM_2WayNodeRefine1Sided(ctrl_t *ctrl, graph_t *graph, idx_t niter)
 }
 
 
+/*************************************************************************/
+/*! This function performs a one-sided node-based FM refinement of the 
+    separator of a block diagonal (METIS_RTYPE_SEPDENSE). Instead of the
+    weight of the separator it maximizes the density of the two halves
+    that replace the block, borders included, which is what makes a split
+    pass AverageReplaceDensity(). Only the block itself is looked at, so
+    a bisection does not depend on when it is computed.
+    
+    The halves are counted as ExtractBiGraph() builds them: half s is side
+    s with the separator and the borders of the block (ctrl->dbrows/dbcols)
+    as its borders. So moving a vertex out of the separator takes its rows
+    times the columns (and its columns times the rows) of the other half
+    out of the area, and the vertices it pulls into the separator add to 
+    the half of its side. The non-zeros of a separator vertex to the other
+    separator vertices and to the borders are in both halves, and so are 
+    those among the borders (ctrl->dbnz). The moves are ordered by a 
+    first-order estimate of the change in density, see NodeDensityGain(),
+    and the prefix with the highest actual density is kept, subject to 
+    the usual balance constraint.
+
+    rwgt[i] is the weight of the rows merged into vertex i, and inz[i] the
+    number of its non-zeros that are counted again when it is in the 
+    separator, see Setup2WayNodeDensityInfo(). */
+/**************************************************************************/
+void FM_2WayNodeRefineDensity(ctrl_t *ctrl, graph_t *graph, idx_t niter, 
+         idx_t *rwgt, idx_t *inz)
+{
+  idx_t i, ii, j, k, jj, kk, nvtxs, nbnd, nswaps, nmind, iend;
+  idx_t *xadj, *vwgt, *adjncy, *adjwgt, *where, *pwgts, *edegrees, *bndind, *bndptr;
+  idx_t *mptr, *mind, *swaps, *rdegrees, *sdegrees;
+  rpq_t *queue; 
+  nrinfo_t *rinfo;
+  idx_t higain, maxorder, pass, to, other, limit;
+  idx_t badmaxpwgt, mindiff, newdiff, maxsep;
+  idx_t nz, snz, ssum, rows[3], cols[3], dims[4];
+  real_t mult, density, curdensity, maxdensity, initdensity;
+
+/* The estimated gain of moving separator vertex i to side to */
+#define NODEDENSITYGAIN(i) \
+    NodeDensityGain(rwgt[i], vwgt[i]-rwgt[i], rdegrees[2*(i)+other], \
+        rinfo[i].edegrees[other]-rdegrees[2*(i)+other], inz[i]+sdegrees[i], dims, density)
+
+  WCOREPUSH;
+
+  nvtxs  = graph->nvtxs;
+  xadj   = graph->xadj;
+  adjncy = graph->adjncy;
+  adjwgt = graph->adjwgt;
+  vwgt   = graph->vwgt;
+
+  bndind = graph->bndind;
+  bndptr = graph->bndptr;
+  where  = graph->where;
+  pwgts  = graph->pwgts;
+  rinfo  = graph->nrinfo;
+
+  queue = rpqCreate(nvtxs);
+
+  swaps = iwspacemalloc(ctrl, nvtxs);
+  mptr  = iwspacemalloc(ctrl, nvtxs+1);
+  mind  = iwspacemalloc(ctrl, 2*nvtxs);
+
+  /* the row weights of the neighbors on each side and the non-zeros to
+     the other separator vertices, of the separator vertices */
+  rdegrees = iwspacemalloc(ctrl, 2*nvtxs);
+  sdegrees = iwspacemalloc(ctrl, nvtxs);
+
+  mult = 0.5*ctrl->ubfactors[0];
+  badmaxpwgt = (idx_t)(mult*(pwgts[0]+pwgts[1]+pwgts[2]));
+
+  /* the rows and columns of the sides, and the non-zeros of the block
+     and between the block and its borders */
+  iset(3, 0, rows);
+  iset(3, 0, cols);
+  for (nz=0, i=0; i<nvtxs; i++) {
+    rows[where[i]] += rwgt[i];
+    cols[where[i]] += vwgt[i]-rwgt[i];
+    nz += inz[i];
+  }
+  nz += isum(xadj[nvtxs], adjwgt, 1)/2;
+
+  IFSET(ctrl->dbglvl, METIS_DBG_REFINE,
+    printf("Partitions-ND: [%6"PRIDX" %6"PRIDX"] Nv-Nb[%6"PRIDX" %6"PRIDX"]. ISep: %6"PRIDX"\n", pwgts[0], pwgts[1], graph->nvtxs, graph->nbnd, graph->mincut));
+
+  to = (pwgts[0] < pwgts[1] ? 1 : 0);
+  for (pass=0; pass<2*niter; pass++) {  /* the 2*niter is for the two sides */
+    other = to; 
+    to    = (to+1)%2;
+
+    rpqReset(queue);
+
+    nbnd = graph->nbnd;
+
+    for (snz=0, ssum=0, ii=0; ii<nbnd; ii++) {
+      i = bndind[ii];
+      rdegrees[2*i] = rdegrees[2*i+1] = sdegrees[i] = 0;
+      for (j=xadj[i]; j<xadj[i+1]; j++) {
+        k = adjncy[j];
+        if (where[k] == 2)
+          sdegrees[i] += adjwgt[j];
+        else
+          rdegrees[2*i+where[k]] += rwgt[k];
+      }
+      snz  += inz[i];
+      ssum += sdegrees[i];
+    }
+    snz += ssum/2;
+
+    /* the gains are estimated with the density and the sizes of the 
+       halves at the start of the pass */
+    initdensity = maxdensity = density = NodeDensity(ctrl, rows, cols, nz+snz);
+    dims[0] = rows[to]+rows[2]+ctrl->dbrows;
+    dims[1] = cols[to]+cols[2]+ctrl->dbcols;
+    dims[2] = rows[other]+rows[2]+ctrl->dbrows;
+    dims[3] = cols[other]+cols[2]+ctrl->dbcols;
+
+    maxorder = -1;
+    maxsep   = pwgts[2];
+
+    /* use the swaps array in place of the traditional perm array to save memory */
+    irandArrayPermute(nbnd, swaps, nbnd, 1);
+    for (ii=0; ii<nbnd; ii++) {
+      i = bndind[swaps[ii]];
+      ASSERT(where[i] == 2);
+      rpqInsert(queue, i, NODEDENSITYGAIN(i));
+    }
+
+    ASSERT(CheckNodeBnd(graph, nbnd));
+    ASSERT(CheckNodePartitionParams(graph));
+
+    limit = gk_min(3*nbnd, 300);
+
+    /******************************************************
+    * Get into the FM loop
+    *******************************************************/
+    mptr[0] = nmind = 0;
+    mindiff = iabs(pwgts[0]-pwgts[1]);
+    for (nswaps=0; nswaps<nvtxs; nswaps++) {
+      if ((higain = rpqGetTop(queue)) == -1)
+        break;
+
+      ASSERT(bndptr[higain] != -1);
+
+      /* The following check is to ensure we break out if there is a posibility
+         of over-running the mind array.  */
+      if (nmind + xadj[higain+1]-xadj[higain] >= 2*nvtxs-1) 
+        break;
+
+      if (pwgts[to]+vwgt[higain] > badmaxpwgt) 
+        break;  /* No point going any further. Balance will be bad */
+
+      snz -= inz[higain] + sdegrees[higain];
+
+      BNDDelete(nbnd, bndind, bndptr, higain);
+      INC_DEC(pwgts[to], pwgts[2], vwgt[higain]);
+      INC_DEC(rows[to], rows[2], rwgt[higain]);
+      INC_DEC(cols[to], cols[2], vwgt[higain]-rwgt[higain]);
+      where[higain] = to;
+      swaps[nswaps] = higain;  
+
+
+      /**********************************************************
+      * Update the degrees of the affected nodes
+      ***********************************************************/
+      for (j=xadj[higain]; j<xadj[higain+1]; j++) {
+        k = adjncy[j];
+
+        if (where[k] == 2) { /* For the in-separator vertices modify their degrees */
+          rinfo[k].edegrees[to] += vwgt[higain];
+          rdegrees[2*k+to]      += rwgt[higain];
+          sdegrees[k]           -= adjwgt[j];
+          rpqUpdate(queue, k, NODEDENSITYGAIN(k));
+        }
+        else if (where[k] == other) { /* This vertex is pulled into the separator */
+          ASSERTP(bndptr[k] == -1, ("%"PRIDX" %"PRIDX" %"PRIDX"\n", k, bndptr[k], where[k]));
+          BNDInsert(nbnd, bndind, bndptr, k);
+
+          mind[nmind++] = k;  /* Keep track for rollback */
+          where[k] = 2;
+          INC_DEC(pwgts[2], pwgts[other], vwgt[k]);
+          INC_DEC(rows[2], rows[other], rwgt[k]);
+          INC_DEC(cols[2], cols[other], vwgt[k]-rwgt[k]);
+
+          edegrees = rinfo[k].edegrees;
+          edegrees[0] = edegrees[1] = 0;
+          rdegrees[2*k] = rdegrees[2*k+1] = sdegrees[k] = 0;
+          for (jj=xadj[k], iend=xadj[k+1]; jj<iend; jj++) {
+            kk = adjncy[jj];
+            if (where[kk] != 2) {
+              edegrees[where[kk]]       += vwgt[kk];
+              rdegrees[2*k+where[kk]]   += rwgt[kk];
+            }
+            else {
+              sdegrees[k] += adjwgt[jj];
+
+              rinfo[kk].edegrees[other] -= vwgt[k];
+              rdegrees[2*kk+other]      -= rwgt[k];
+              sdegrees[kk]              += adjwgt[jj];
+
+              /* Since the moves are one-sided this vertex has not been moved yet */
+              rpqUpdate(queue, kk, NODEDENSITYGAIN(kk)); 
+            }
+          }
+          snz += inz[k] + sdegrees[k];
+
+          /* Insert the new vertex into the priority queue. Safe due to one-sided moves */
+          rpqInsert(queue, k, NODEDENSITYGAIN(k));
+        }
+      }
+      mptr[nswaps+1] = nmind;
+
+      curdensity = NodeDensity(ctrl, rows, cols, nz+snz);
+
+      IFSET(ctrl->dbglvl, METIS_DBG_MOVEINFO,
+            printf("Moved %6"PRIDX" to %3"PRIDX", Density: %.6f \t[%5"PRIDX" %5"PRIDX" %5"PRIDX"] [%3"PRIDX" %2"PRIDX"]\n", 
+                higain, to, curdensity, pwgts[0], pwgts[1], pwgts[2], nswaps, limit));
+
+      newdiff = iabs(pwgts[to]-pwgts[other]);
+      if (curdensity > maxdensity || (curdensity == maxdensity && newdiff < mindiff)) {
+        maxdensity = curdensity;
+        maxorder   = nswaps;
+        maxsep     = pwgts[2];
+        mindiff    = newdiff;
+      }
+      else {
+        if (nswaps - maxorder > 3*limit || 
+            (nswaps - maxorder > limit && pwgts[2] > 1.10*maxsep)) {
+          nswaps++;
+          break; /* No further improvement, break out */
+        }
+      }
+    }
+
+
+    /****************************************************************
+    * Roll back computation 
+    *****************************************************************/
+    for (nswaps--; nswaps>maxorder; nswaps--) {
+      higain = swaps[nswaps];
+
+      ASSERT(CheckNodePartitionParams(graph));
+      ASSERT(where[higain] == to);
+
+      INC_DEC(pwgts[2], pwgts[to], vwgt[higain]);
+      INC_DEC(rows[2], rows[to], rwgt[higain]);
+      INC_DEC(cols[2], cols[to], vwgt[higain]-rwgt[higain]);
+      where[higain] = 2;
+      BNDInsert(nbnd, bndind, bndptr, higain);
+
+      edegrees = rinfo[higain].edegrees;
+      edegrees[0] = edegrees[1] = 0;
+      for (j=xadj[higain]; j<xadj[higain+1]; j++) {
+        k = adjncy[j];
+        if (where[k] == 2) 
+          rinfo[k].edegrees[to] -= vwgt[higain];
+        else
+          edegrees[where[k]] += vwgt[k];
+      }
+
+      /* Push nodes out of the separator */
+      for (j=mptr[nswaps]; j<mptr[nswaps+1]; j++) {
+        k = mind[j];
+        ASSERT(where[k] == 2);
+        where[k] = other;
+        INC_DEC(pwgts[other], pwgts[2], vwgt[k]);
+        INC_DEC(rows[other], rows[2], rwgt[k]);
+        INC_DEC(cols[other], cols[2], vwgt[k]-rwgt[k]);
+        BNDDelete(nbnd, bndind, bndptr, k);
+        for (jj=xadj[k], iend=xadj[k+1]; jj<iend; jj++) {
+          kk = adjncy[jj];
+          if (where[kk] == 2) 
+            rinfo[kk].edegrees[other] += vwgt[k];
+        }
+      }
+    }
+
+    IFSET(ctrl->dbglvl, METIS_DBG_REFINE,
+      printf("\tMaximum density: %.6f at %5"PRIDX", Sep: %6"PRIDX", PWGTS: [%6"PRIDX" %6"PRIDX"], NBND: %6"PRIDX"\n", maxdensity, maxorder, pwgts[2], pwgts[0], pwgts[1], nbnd));
+
+    graph->mincut = pwgts[2];
+    graph->nbnd   = nbnd;
+
+    if (pass%2 == 1 && (maxorder == -1 || maxdensity <= initdensity))
+      break;
+  }
+
+#undef NODEDENSITYGAIN
+
+  rpqDestroy(queue);
+
+  WCOREPOP;
+}
+
+
+/*************************************************************************/
+/*! This function returns the density of the halves that replace the
+    block being bisected, whose rows and columns on the left/right/separator
+    are rows[] and cols[] and that have nz non-zeros besides those among
+    the borders. This is the snz over the sarea of the two blocks that
+    ExtractBiGraph() would extract. */
+/*************************************************************************/
+real_t NodeDensity(ctrl_t *ctrl, idx_t *rows, idx_t *cols, idx_t nz)
+{
+  idx_t area;
+
+  area = (rows[0]+rows[2]+ctrl->dbrows)*(cols[0]+cols[2]+ctrl->dbcols) +
+         (rows[1]+rows[2]+ctrl->dbrows)*(cols[1]+cols[2]+ctrl->dbcols);
+
+  return 1.0*(ctrl->dbnz+nz)/area;
+}
+
+
+/*************************************************************************/
+/*! This function returns the first-order change in density of moving a 
+    separator vertex with rmove rows and cmove columns to a side, which 
+    pulls rpull rows and cpull columns of the other side into the 
+    separator and takes snz non-zeros out of the separator. dims[0..1] 
+    are the rows and columns of the half of that side, dims[2..3] of the
+    other half. */
+/*************************************************************************/
+real_t NodeDensityGain(idx_t rmove, idx_t cmove, idx_t rpull, idx_t cpull, 
+         idx_t snz, idx_t *dims, real_t density)
+{
+  idx_t darea;
+
+  darea = rpull*dims[1] + cpull*dims[0] + rpull*cpull 
+        - rmove*dims[3] - cmove*dims[2] + rmove*cmove;
+
+  return -snz - density*darea;
+}
+
+
 /*************************************************************************/
 /*! This function balances the left/right partitions of a separator 
     tri-section */
@@ -22,6 +22,8 @@
 /*************************************************************************/
 void Refine2WayNode(ctrl_t *ctrl, graph_t *orggraph, graph_t *graph)
 {
+  idx_t l, level, nlevels=0;
+  idx_t **rwgts=NULL, **inzs=NULL;
 
   IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_startcputimer(ctrl->UncoarsenTmr));
 
@@ -29,8 +31,16 @@ void Refine2WayNode(ctrl_t *ctrl, graph_t *orggraph, graph_t *graph)
     Compute2WayNodePartitionParams(ctrl, graph);
   }
   else {
+    /* the density refinement tells the rows from the columns by the labels
+       of orggraph, the coarse graphs of the trials of a coarse graph are 
+       refined one-sided instead */
+    if (ctrl->rtype == METIS_RTYPE_SEPDENSE && orggraph->label != NULL && !ctrl->compressed)
+      nlevels = Setup2WayNodeDensityInfo(ctrl, orggraph, graph, &rwgts, &inzs);
+
+    level = nlevels-1;
     do {
       graph = graph->finer;
+      level--;
 
       IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_startcputimer(ctrl->ProjectTmr));
       Project2WayNodePartition(ctrl, graph);
@@ -48,18 +58,93 @@ void Refine2WayNode(ctrl_t *ctrl, graph_t *orggraph, graph_t *graph)
         case METIS_RTYPE_SEP1SIDED:
           FM_2WayNodeRefine1Sided(ctrl, graph, ctrl->niter); 
           break;
+        case METIS_RTYPE_SEPDENSE:
+          if (nlevels > 0)
+            FM_2WayNodeRefineDensity(ctrl, graph, ctrl->niter, rwgts[level], inzs[level]); 
+          else
+            FM_2WayNodeRefine1Sided(ctrl, graph, ctrl->niter); 
+          break;
         default:
           gk_errexit(SIGERR, "Unknown rtype of %d\n", ctrl->rtype);
       }
       IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->RefTmr));
 
     } while (graph != orggraph);
+
+    for (l=0; l<nlevels; l++)
+      gk_free((void **)&rwgts[l], &inzs[l], LTERM);
+    gk_free((void **)&rwgts, &inzs, LTERM);
   }
 
   IFSET(ctrl->dbglvl, METIS_DBG_TIME, gk_stopcputimer(ctrl->UncoarsenTmr));
 }
 
 
+/*************************************************************************/
+/*! This function computes what FM_2WayNodeRefineDensity() needs to know
+    about the vertices of the levels from orggraph down to graph: the 
+    weight of the rows merged into each vertex (rwgts) and the number of
+    non-zeros that both halves get when it is in the separator, besides
+    those to the other separator vertices (inzs). These are the non-zeros
+    collapsed inside the vertex and those to the borders of the block,
+    which are its edges in ctrl->obigraph that orggraph does not have.
+    The rows of orggraph are its vertices whose label is less than 
+    ctrl->nrows. It returns the number of levels, level 0 is orggraph. */
+/*************************************************************************/
+idx_t Setup2WayNodeDensityInfo(ctrl_t *ctrl, graph_t *orggraph, graph_t *graph,
+          idx_t ***r_rwgts, idx_t ***r_inzs)
+{
+  idx_t i, j, l, nlevels;
+  idx_t *xadj, *adjncy, *adjwgt, *cmap, *rwgt, *inz, *crwgt, *cinz, *oxadj;
+  idx_t **rwgts, **inzs;
+  graph_t *g;
+
+  for (nlevels=1, g=orggraph; g != graph; g=g->coarser)
+    nlevels++;
+
+  rwgts = (idx_t **)gk_malloc(nlevels*sizeof(idx_t *), "Setup2WayNodeDensityInfo: rwgts");
+  inzs  = (idx_t **)gk_malloc(nlevels*sizeof(idx_t *), "Setup2WayNodeDensityInfo: inzs");
+
+  rwgt = rwgts[0] = imalloc(orggraph->nvtxs, "Setup2WayNodeDensityInfo: rwgts[0]");
+  inz  = inzs[0]  = imalloc(orggraph->nvtxs, "Setup2WayNodeDensityInfo: inzs[0]");
+  oxadj = ctrl->obigraph->super->xadj;
+  xadj  = orggraph->xadj;
+  for (i=0; i<orggraph->nvtxs; i++) {
+    rwgt[i] = (orggraph->label[i] < ctrl->nrows ? orggraph->vwgt[i] : 0);
+    inz[i]  = (oxadj[orggraph->label[i]+1]-oxadj[orggraph->label[i]]) - (xadj[i+1]-xadj[i]);
+  }
+
+  for (l=0, g=orggraph; g != graph; l++, g=g->coarser) {
+    xadj   = g->xadj;
+    adjncy = g->adjncy;
+    adjwgt = g->adjwgt;
+    cmap   = g->cmap;
+
+    crwgt = rwgts[l+1] = ismalloc(g->coarser->nvtxs, 0, "Setup2WayNodeDensityInfo: rwgts[l]");
+    cinz  = inzs[l+1]  = ismalloc(g->coarser->nvtxs, 0, "Setup2WayNodeDensityInfo: inzs[l]");
+
+    for (i=0; i<g->nvtxs; i++) {
+      crwgt[cmap[i]] += rwgt[i];
+      cinz[cmap[i]]  += inz[i];
+
+      /* the edges inside a coarse vertex are counted from their smaller end */
+      for (j=xadj[i]; j<xadj[i+1]; j++) {
+        if (adjncy[j] > i && cmap[adjncy[j]] == cmap[i])
+          cinz[cmap[i]] += adjwgt[j];
+      }
+    }
+
+    rwgt = crwgt;
+    inz  = cinz;
+  }
+
+  *r_rwgts = rwgts;
+  *r_inzs  = inzs;
+
+  return nlevels;
+}
+
+
 /*************************************************************************/
 /*! This function allocates memory for 2-way node-based refinement */
 /**************************************************************************/
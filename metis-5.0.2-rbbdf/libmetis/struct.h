@@ -117,19 +117,35 @@ typedef struct graph_t {
   nrinfo_t *nrinfo;
 
   struct graph_t *coarser, *finer;
+
+  /* evison */
+  struct chier_t *chier;	/* The coarsening hierarchy of the graph, see ctrl->inherit */
 } graph_t;
 
 /*evison*/
-//typedef struct border_t {
-//	idx_t nrows;	/* number of row vertices in this border */
-//	idx_t ncols;	/* number of column vertices in this border */
-//	idx_t area;		/* area = nrows * ncols */
-//	idx_t nonzeros;	/* number of non-zeros in this border */
-//	idx_t *rlabel;	/* maps row indices of this bigrah to the original graph */
-//	idx_t *clabel;	/* maps column indices of this bigrah to the original graph */
-//	struct border_t *right;	/* points to the next border in the right side */
-//	struct border_t *down;	/* points to the next border in the down side */
-//} border_t;
+/* A coarsening hierarchy, i.e., the cmaps of the levels of a multilevel
+ * bisection without the coarse graphs. Level l maps the nvtxs[l] vertices
+ * of that level onto the nvtxs[l+1] vertices of level l+1, and its cmap
+ * starts at cmap+ptr[l]. The coarse vertices of a level are numbered in 
+ * the order of their first vertex, as CreateCoarseGraph() requires */
+typedef struct chier_t {
+	idx_t nlevels;	/* number of levels */
+	idx_t *nvtxs;	/* nlevels+1 numbers of vertices */
+	idx_t *ptr;		/* nlevels offsets into cmap */
+	idx_t *cmap;	/* the cmaps of all the levels */
+} chier_t;
+
+/*evison*/
+/* A border group, i.e., the row and column vertices of a separator. It is
+ * shared by all the block diagonals that were split off below the separator,
+ * and kept in the table ctrl->borders */
+typedef struct border_t {
+	idx_t nrows;	/* number of row vertices in this border */
+	idx_t ncols;	/* number of column vertices in this border */
+	idx_t *rlabel;	/* maps row indices of this border to the original graph */
+	idx_t *clabel;	/* maps column indices of this border to the original graph */
+	idx_t ref;		/* number of bigraphs using this border */
+} border_t;
 
 typedef struct label_t {
 	idx_t *label;
@@ -137,19 +153,31 @@ typedef struct label_t {
 } label_t;
 
 /*evison*/
-/*bigraph_t can also be used as border_t, variables marked with 'b' are for border_t */
+/* A block diagonal. Its borders are the border groups brds[0..nbrds-1] of
+ * ctrl->borders, the latest separator first. Row group 0 and column group 0
+ * are the block itself, row/column group t+1 is border group brds[t], and
+ * bnz[i*(nbrds+1)+j] is the number of non-zeros between row group i and
+ * column group j. brds and bnz share a single allocation */
 typedef struct bigraph_t {
 	graph_t* super;	/*   the corresponding graph structure of this bigraph */
 	idx_t lastvtx;	/*   the last vertex index for this bigraph */
-	idx_t nrows;	/* b  number of row vertices in this bigraph */
-	idx_t ncols;	/* b  number of column vertices in this bigraph */
-	idx_t area;		/* b  area = nrows * ncols */
-	idx_t nz;		/* b  number of non-zeros in this border */
+	idx_t nrows;	/*   number of row vertices in this bigraph */
+	idx_t ncols;	/*   number of column vertices in this bigraph */
+	idx_t area;		/*   area = nrows * ncols */
+	idx_t nz;		/*   number of non-zeros in this bigraph */
+	idx_t snz;		/*   number of non-zeros in this bigraph and all its borders */
+	idx_t sarea;	/*   area of this bigraph and all its borders */
 	idx_t partible;	/*    whether the graph is partible */
-	struct label_t* rlabel;		/* b maps row indices of this bigrah to the original graph */
-	struct label_t* clabel;		/* b maps column indices of this bigrah to the original graph */
-	struct bigraph_t *right;	/* b points to the first right border */
-	struct bigraph_t *down;		/* b points to the first down border */
+	idx_t bisect;	/*   whether it is bisected with kappa > 2: it is small, or its last split was rejected */
+	idx_t *cwhere;	/*   separator of the last rejected bisection, NULL if none */
+	idx_t csnz;		/*   snz of the two blocks of the rejected bisection */
+	idx_t csarea;	/*   sarea of the two blocks of the rejected bisection */
+	idx_t carea;	/*   area of the two blocks of the rejected bisection */
+	struct label_t* rlabel;		/* maps row indices of this bigrah to the original graph */
+	struct label_t* clabel;		/* maps column indices of this bigrah to the original graph */
+	idx_t nbrds;	/*   number of border groups of this bigraph */
+	idx_t *brds;	/*   ids of the border groups in ctrl->borders */
+	idx_t *bnz;		/*   (nbrds+1)*(nbrds+1) non-zeros of the bigraph and its borders */
 	struct bigraph_t *next;		/*   points to the next bigraph (block diagonal) */
 } bigraph_t;
 
@@ -239,8 +267,21 @@ typedef struct ctrl_t {
   idx_t ncols;
   idx_t kappa;
   idx_t ndiags;
+  idx_t nthreads;	/* number of candidate blocks bisected concurrently */
+  mselect_et select;	/* how the block diagonal to split is selected */
   idx_t compressed;	/* trancks whether a graph is compressed */
+  idx_t snz;		/* running total of non-zeros over the block diagonal list */
+  idx_t sarea;		/* running total of area over the block diagonal list */
+  idx_t *bndmark;	/* maps each vertex of obigraph to its border group, -1 if unmarked */
+  border_t *borders;	/* the border groups of all separators taken so far */
+  idx_t nborders;	/* number of entries used in borders */
+  idx_t maxborders;	/* number of entries allocated for borders */
   bigraph_t *obigraph;
+  bdfstats_t *stats;	/* the statistics of this METIS_NodeBDF() call */
+  idx_t inherit;	/* if the blocks are coarsened by restricting the hierarchy of their parent */
+  idx_t dbnz;		/* number of non-zeros among the borders of the block being bisected, once per half */
+  idx_t dbrows;		/* number of border rows of the block being bisected */
+  idx_t dbcols;		/* number of border columns of the block being bisected */
 
 } ctrl_t;
 
@@ -19,7 +19,7 @@ static struct gk_option long_options[] = {
   {"rtype",          1,      0,      METIS_OPTION_RTYPE},
   {"ufactor",        1,      0,      METIS_OPTION_UFACTOR},
   {"pfactor",        1,      0,      METIS_OPTION_PFACTOR},
-  {"nocompress",     0,      0,      METIS_OPTION_COMPRESS},
+  {"compress",       0,      0,      METIS_OPTION_COMPRESS},
   {"ccorder",        0,      0,      METIS_OPTION_CCORDER},
   {"nooutput",       0,      0,      METIS_OPTION_NOOUTPUT},
   {"niter",          1,      0,      METIS_OPTION_NITER},
@@ -35,6 +35,15 @@ static struct gk_option long_options[] = {
   {"nrows",          1,      0,      METIS_OPTION_NROWS},
   {"ncols",          1,      0,      METIS_OPTION_NCOLS},
   {"ndiags",         1,      0,      METIS_OPTION_NDIAGS},
+  {"nthreads",       1,      0,      METIS_OPTION_NTHREADS},
+  {"select",         1,      0,      METIS_OPTION_SELECT},
+  {"informat",       1,      0,      METIS_OPTION_INFORMAT},
+  {"outfmt",         1,      0,      METIS_OPTION_OUTFMT},
+  {"shards",         1,      0,      METIS_OPTION_SHARDS},
+  {"server",         0,      0,      METIS_OPTION_SERVER},
+  {"socket",         1,      0,      METIS_OPTION_SOCKET},
+  {"nworkers",       1,      0,      METIS_OPTION_NWORKERS},
+  {"inherit",        0,      0,      METIS_OPTION_INHERIT},
   {0,                0,      0,      0}
 };
 
@@ -42,6 +51,7 @@ static struct gk_option long_options[] = {
 static gk_StringMap_t ctype_options[] = {
  {"rm",                 METIS_CTYPE_RM},
  {"shem",               METIS_CTYPE_SHEM},
+ {"phem",               METIS_CTYPE_PHEM},
  {NULL,                 0}
 };
 
@@ -52,9 +62,38 @@ static gk_StringMap_t iptype_options[] = {
  {NULL,                 0}
 };
 
+static gk_StringMap_t select_options[] = {
+ {"first",              METIS_SELECT_FIRST},
+ {"best",               METIS_SELECT_BEST},
+ {"ratio",              METIS_SELECT_RATIO},
+ {NULL,                 0}
+};
+
+static gk_StringMap_t informat_options[] = {
+ {"graph",              METIS_INFORMAT_GRAPH},
+ {"matrix",             METIS_INFORMAT_MATRIX},
+ {"triples",            METIS_INFORMAT_TRIPLES},
+ {NULL,                 0}
+};
+
+static gk_StringMap_t outfmt_options[] = {
+ {"text",               METIS_OUTFMT_TEXT},
+ {"bin",                METIS_OUTFMT_BIN},
+ {"varint",             METIS_OUTFMT_VARINT},
+ {NULL,                 0}
+};
+
+static gk_StringMap_t shards_options[] = {
+ {"none",               METIS_SHARDS_NONE},
+ {"block",              METIS_SHARDS_BLOCK},
+ {"bordered",           METIS_SHARDS_BORDERED},
+ {NULL,                 0}
+};
+
 static gk_StringMap_t rtype_options[] = {
  {"2sided",             METIS_RTYPE_SEP2SIDED},
  {"1sided",             METIS_RTYPE_SEP1SIDED},
+ {"dense",              METIS_RTYPE_SEPDENSE},
  {"fm",                 METIS_RTYPE_FM},
  {NULL,                 0}
 };
@@ -76,7 +115,11 @@ static char helpstr[][100] =
 "Usage: rbbdf [options] <filename>",
 " ",
 " Required parameters",
-"    filename    Stores the graph to be partitioned.",
+"    filename    Stores the graph to be partitioned, either as a text",
+"                graph file or as a binary CSR file written by graph2bin.",
+"                The latter is mapped into memory instead of being parsed,",
+"                and it supplies -nrows/-ncols if they are not given.",
+"                See -informat for the other input formats.",
 " ",
 " Optional parameters",
 "  -density",
@@ -88,13 +131,99 @@ static char helpstr[][100] =
 "  -ncols",
 "     Number of column vertices in the bipartite graph",
 " ",
-"  -kappa",
-"     Number of vertex separators to compute in each round,",
-"     the best one will be taken as the final separator",
+"  -kappa=int",
+"     Number of diagonal blocks each split produces, the blocks share",
+"     one border found as a k-way vertex separator. Default is 2.",
+" ",
+"  -nthreads=int",
+"     Number of candidate blocks that are bisected concurrently in each",
+"     round. Requires a build with OpenMP support. Default is 1.",
+" ",
+"  -nseps=int",
+"     Number of different separators computed for each split, the",
+"     smallest one is used. They are computed concurrently on -nthreads",
+"     threads. Default is 1.",
+" ",
+"  -select=string",
+"     Specifies how the block diagonal to split is selected in each round.",
+"     The possible values are:",
+"        first    - The first block, in area order, whose split improves",
+"                   the average density [default]",
+"        best     - The split of all blocks with the largest density gain",
+"        ratio    - The split of all blocks with the largest density gain",
+"                   per unit of new border area",
+" ",
+"  -informat=string",
+"     Specifies the format of the input file.",
+"     The possible values are:",
+"        graph    - A graph file, text or binary, whose vertices 1..nrows",
+"                   are the rows and the others the columns [default]",
+"        matrix   - A .matrix file of a dense binary matrix, the default",
+"                   for the files ending in .matrix",
+"        triples  - One user item [rating] triple per line. The ids can be",
+"                   any non-negative numbers and are renumbered, the",
+"                   original ids of the vertices are written to",
+"                   <filename>.ids. The rating is ignored.",
+"     The last two build the bipartite graph in memory and set -nrows",
+"     and -ncols from the file.",
+" ",
+"  -outfmt=string",
+"     Specifies the format of the output files.",
+"     The possible values are:",
+"        text     - The <filename>.iperm and <filename>.diags text files",
+"                   [default]",
+"        bin      - The <filename>.iperm.bin and <filename>.diags.bin",
+"                   binary files, which store the permutation and the",
+"                   blocks as idx_t arrays that can be mapped into memory",
+"        varint   - The same binary files with the arrays delta-varint",
+"                   encoded, which are several times smaller",
+" ",
+"  -shards=string",
+"     Also writes the sub-matrix of each diagonal block i to the binary",
+"     file <filename>.shard.i, as a CSR matrix with local indices followed",
+"     by the ids of its rows and columns. The possible values are:",
+"        none     - No shards are written [default]",
+"        block    - The rows and columns that are in no other block",
+"        bordered - All the rows and columns of the block, including the",
+"                   borders that it shares with other blocks",
+" ",
+"  -server",
+"     Reads the graph once and then orders it for each job read from",
+"     stdin, one per line, until the end of the input. A job is a list",
+"     of key=value pairs out of",
+"        out=path      - The prefix of the output files [required]",
+"        density=float - Overrides -density, required if -density is not",
+"                        given",
+"        ndiags=int    - Overrides -ndiags",
+"        seed=int      - Overrides -seed",
+"        id=int        - Is echoed in the response, the default is the",
+"                        # of the job in the input",
+"     and a line 'job <id> ok <out> ...' or 'job <id> error <reason>'",
+"     is written to stdout once the job is done. The progress of the",
+"     orderings goes to stderr. The line 'shutdown' stops the server.",
+" ",
+"  -socket=path",
+"     Runs the server on the UNIX socket path instead of stdin, each",
+"     connection sends jobs and receives their responses as above.",
+" ",
+"  -nworkers=int",
+"     Number of jobs the server runs concurrently. Requires a build with",
+"     OpenMP support. Default is 1.",
 " ",
 "  -ccorder",
 "     Extract connected components before separation",
 " ",
+"  -compress",
+"     Merge the rows with identical column sets and the columns with",
+"     identical row sets of a block before separating it",
+" ",
+"  -inherit",
+"     Coarsen each block that was split off a larger one by restricting",
+"     the coarsening hierarchy of its parent to its vertices, instead of",
+"     matching it from scratch. The levels that the restriction does not",
+"     reduce enough are matched as usual. Has no effect on the blocks that",
+"     are compressed.",
+" ",
 "  -iptype=string [applies only when -ptype=rb]",
 "     Specifies the scheme to be used to compute the initial bisection",
 "     of the graph.",
@@ -108,12 +237,18 @@ static char helpstr[][100] =
 "     The possible values are:",
 "        rm       - Random matching",
 "        shem     - Sorted heavy-edge matching [default]",
+"        phem     - Heavy-edge matching in rounds of handshakes. The",
+"                   matching and the contraction are split over the",
+"                   -nthreads threads, and do not depend on their number",
+"                   as long as it is above 1. With one thread it is shem",
 " ",
 "  -rtype=string",
 "     Specifies the scheme to be used for refinement.",
 "     The possible values are:",
 "        1sided   - 1-sided node-based refinement [default]",
 "        2sided   - 2-sided node-based refinement",
+"        dense    - 1-sided node-based refinement that moves the vertices",
+"                   by the density of the resulting block diagonals",
 " ",
 "  -seed=int",
 "     Selects the seed of the random number generator.  ",
@@ -124,11 +259,6 @@ static char helpstr[][100] =
 "  -help",
 "     Prints this message.",
 ""
-/*
-"  -nocompress",
-"     Do not compress a graph and do separation directly",
-" ",
-*/
 };
 
 static char shorthelpstr[][100] = {
@@ -174,8 +304,17 @@ params_t *parse_cmdline(int argc, char *argv[])
   params->density = -1;
   params->nrows = -1;
   params->ncols = -1;
-  params->kappa = 1;
+  params->kappa = 2;
   params->ndiags = -1;
+  params->nthreads = 1;
+  params->select = METIS_SELECT_FIRST;
+  params->informat = -1;
+  params->outfmt = METIS_OUTFMT_TEXT;
+  params->shards = METIS_SHARDS_NONE;
+  params->server = 0;
+  params->socket = NULL;
+  params->nworkers = 1;
+  params->inherit = 0;
 
   gk_clearcputimer(params->iotimer);
   gk_clearcputimer(params->parttimer);
@@ -200,15 +339,19 @@ params_t *parse_cmdline(int argc, char *argv[])
           if ((params->rtype = gk_GetStringID(rtype_options, gk_optarg)) == -1)
             errexit("Invalid option -%s=%s\n", long_options[option_index].name, gk_optarg);
         break;
-/*
+
       case METIS_OPTION_COMPRESS:
-        params->compress = 0;
+        params->compress = 1;
         break;
-*/
+
       case METIS_OPTION_CCORDER:
         params->ccorder = 1;
         break;
 
+      case METIS_OPTION_NSEPS:
+        if (gk_optarg) params->nseps = (idx_t)atoi(gk_optarg);
+        break;
+
       case METIS_OPTION_SEED:
         if (gk_optarg) params->seed = (idx_t)atoi(gk_optarg);
         break;
@@ -238,6 +381,53 @@ params_t *parse_cmdline(int argc, char *argv[])
     	  if (gk_optarg) params->ndiags = (idx_t)atoi(gk_optarg);
     	  break;
 
+      case METIS_OPTION_NTHREADS:
+    	  if (gk_optarg) params->nthreads = (idx_t)atoi(gk_optarg);
+    	  break;
+
+      case METIS_OPTION_SELECT:
+        if (gk_optarg)
+          if ((params->select = gk_GetStringID(select_options, gk_optarg)) == -1)
+            errexit("Invalid option -%s=%s\n", long_options[option_index].name, gk_optarg);
+        break;
+
+      case METIS_OPTION_INFORMAT:
+        if (gk_optarg)
+          if ((params->informat = gk_GetStringID(informat_options, gk_optarg)) == -1)
+            errexit("Invalid option -%s=%s\n", long_options[option_index].name, gk_optarg);
+        break;
+
+      case METIS_OPTION_OUTFMT:
+        if (gk_optarg)
+          if ((params->outfmt = gk_GetStringID(outfmt_options, gk_optarg)) == -1)
+            errexit("Invalid option -%s=%s\n", long_options[option_index].name, gk_optarg);
+        break;
+
+      case METIS_OPTION_SHARDS:
+        if (gk_optarg)
+          if ((params->shards = gk_GetStringID(shards_options, gk_optarg)) == -1)
+            errexit("Invalid option -%s=%s\n", long_options[option_index].name, gk_optarg);
+        break;
+
+      case METIS_OPTION_SERVER:
+        params->server = 1;
+        break;
+
+      case METIS_OPTION_SOCKET:
+        if (gk_optarg) {
+          params->server = 1;
+          params->socket = gk_strdup(gk_optarg);
+        }
+        break;
+
+      case METIS_OPTION_NWORKERS:
+        if (gk_optarg) params->nworkers = (idx_t)atoi(gk_optarg);
+        break;
+
+      case METIS_OPTION_INHERIT:
+        params->inherit = 1;
+        break;
+
       case METIS_OPTION_HELP:
         for (i=0; strlen(helpstr[i]) > 0; i++)
           printf("%s\n", helpstr[i]);
@@ -259,6 +449,12 @@ params_t *parse_cmdline(int argc, char *argv[])
 
   params->filename = gk_strdup(argv[gk_optind++]);
 
+  if (params->informat == -1) {
+    i = strlen(params->filename);
+    params->informat = (i > 7 && strcmp(params->filename+i-7, ".matrix") == 0 
+                          ? METIS_INFORMAT_MATRIX : METIS_INFORMAT_GRAPH);
+  }
+
   return params;
 }
 
@@ -38,6 +38,43 @@
 #define CMD_HELP                1001
 
 
+/* The binary CSR graph files (see ReadBinaryGraph()) */
+#define BINGRAPH_MAGIC          "METISCSR"
+#define BINGRAPH_VERSION        1
+
+#define BINGRAPH_VWGT           1       /* the file stores vwgt */
+#define BINGRAPH_ADJWGT         2       /* the file stores adjwgt */
+#define BINGRAPH_VARINT         4       /* the arrays are delta-varint encoded */
+
+/* The # of values of each frame of the delta-varint encoded arrays */
+#define VARINT_FRAMESIZE        (1<<16)
+
+/* The delta-varint codec of GKlib for idx_t */
+#if IDXTYPEWIDTH == 32
+  #define ivencodeframes        gk_i32vencodeframes
+  #define ivdecodeframes        gk_i32vdecodeframes
+#else
+  #define ivencodeframes        gk_i64vencodeframes
+  #define ivdecodeframes        gk_i64vdecodeframes
+#endif
+
+/* The binary output files of rbbdf (see WritePermutationBin()) */
+#define BINIPERM_MAGIC          "METISPRM"
+#define BINDIAGS_MAGIC          "METISBDF"
+#define BINBDF_VERSION          1
+
+#define BINBDF_VARINT           1       /* the arrays are delta-varint encoded */
+
+/* The per-block shards of rbbdf (see WriteShards()) */
+#define BINSHARD_MAGIC          "METISSHD"
+
+/* The size of the chunks in which edges2bin reads its input */
+#define EDGEBUF_SIZE            (1<<24)
+
+/* The size of the buffer of the text output files */
+#define OUTBUF_SIZE             (1<<20)
+
+
 
 
 /* The text labels for PTypes */
@@ -47,13 +84,25 @@ static char ptypenames[][15] = {"rb", "kway"};
 static char objtypenames[][15] = {"cut", "vol", "node"};
 
 /* The text labels for CTypes */
-static char ctypenames[][15] = {"rm", "shem"};
+static char ctypenames[][15] = {"rm", "shem", "phem"};
 
 /* The text labels for RTypes */
-static char rtypenames[][15] = {"fm", "greedy", "2sided", "1sided"};
+static char rtypenames[][15] = {"fm", "greedy", "2sided", "1sided", "dense"};
 
 /* The text labels for ITypes */
 static char iptypenames[][15] = {"grow", "random", "edge", "node", "metisrb"};
 
 /* The text labels for GTypes */
 static char gtypenames[][15] = {"dual", "nodal"};
+
+/* The text labels for the split selection schemes */
+static char selectnames[][15] = {"first", "best", "ratio"};
+
+/* The text labels for the input formats of rbbdf */
+static char informatnames[][15] = {"graph", "matrix", "triples"};
+
+/* The text labels for the output formats of rbbdf */
+static char outfmtnames[][15] = {"text", "bin", "varint"};
+
+/* The text labels for the shard outputs of rbbdf */
+static char shardsnames[][15] = {"none", "block", "bordered"};
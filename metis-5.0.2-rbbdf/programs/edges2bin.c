@@ -0,0 +1,371 @@
+/*
+ * edges2bin.c
+ *
+ * This file builds a binary CSR graph file out of an edge list that may
+ * not fit in memory. The edges are read in sorted runs of bounded size,
+ * the runs are spilled to temporary files, and they are merged straight
+ * into the xadj and adjncy arrays of the output file.
+ *
+ */
+
+#include "metisbin.h"
+
+/* The tag of the column vertices of a bipartite graph during the sort,
+   which keeps them after the rows until their # is known */
+#define COLTAG          ((idx_t)1<<(8*sizeof(idx_t)-2))
+
+#define edge_lt(a, b)   ((a)->u < (b)->u || ((a)->u == (b)->u && (a)->v < (b)->v))
+
+
+/*************************************************************************/
+/*! The entry point of the builder */
+/*************************************************************************/
+int main(int argc, char *argv[])
+{
+  idx_t nvtxs, nrows=0, ncols=0, nruns=0, bipartite=0;
+  size_t mem=512, maxedges, nedges=0, nlines=0, lineno=0, nread, len=0;
+  edge_t *edges;
+  idx_t u, v;
+  char *buf, *s, *lend, *eol, *end;
+  double iotimer=0.0, mergetimer=0.0;
+  FILE *fpin;
+
+  for (; argc > 1 && argv[1][0] == '-'; argc--, argv++) {
+    if (strcmp(argv[1], "-bipartite") == 0)
+      bipartite = 1;
+    else if (strncmp(argv[1], "-mem=", 5) == 0 && atoll(argv[1]+5) > 0)
+      mem = (size_t)atoll(argv[1]+5);
+    else
+      argc = 0;
+  }
+
+  if (argc != 3) {
+    printf("Usage: edges2bin [-bipartite] [-mem=MB] <EdgeFile> <BinaryFile>\n");
+    printf("  Each line of EdgeFile holds the 1-based ids of the two vertices of an\n");
+    printf("  edge, followed by anything else, such as a rating, which is ignored.\n");
+    printf("  With -bipartite they are a row and a column id, and the rows and the\n");
+    printf("  columns are numbered separately, as in the user item rating files.\n");
+    printf("  The ids are not renumbered, the unused ones become isolated vertices.\n");
+    printf("  The duplicate edges are removed. -mem bounds the memory used for the\n");
+    printf("  edges [default 512MB], the larger graphs are sorted in temporary\n");
+    printf("  files next to BinaryFile.\n");
+    exit(0);
+  }
+
+  maxedges = gk_max(2, (mem<<20)/sizeof(edge_t));
+  edges = (edge_t *)gk_malloc(maxedges*sizeof(edge_t), "main: edges");
+  buf   = gk_cmalloc(EDGEBUF_SIZE+1, "main: buf");
+
+  gk_startcputimer(iotimer);
+
+  /*----------------------------------------------------------------------
+   * Read the edges in chunks and spill each full buffer as a sorted run
+   *---------------------------------------------------------------------*/
+  fpin  = gk_fopen(argv[1], "rb", __func__);
+  nvtxs = 0;
+  do {
+    nread = fread(buf+len, 1, EDGEBUF_SIZE-len, fpin);
+    end   = buf + len + nread;
+
+    /* the last line of a chunk is kept for the next one, unless at EOF */
+    if (nread > 0) {
+      for (eol=end; eol>buf && eol[-1] != '\n'; eol--);
+      if (eol == buf && end == buf+EDGEBUF_SIZE)
+        errexit("Line %zu of file %s is too long.\n", lineno+1, argv[1]);
+    }
+    else {
+      eol = end;
+    }
+
+    for (s=buf; s<eol; s=lend) {
+      lend = NextLine(s, eol);
+      lineno++;
+      if (s[0] == '%' || s[0] == '#' || !ReadLineIdx(&s, lend, &u))
+        continue;
+      for (; s<lend && *s != '\n' && !isdigit((int)*s); s++);
+      if (!ReadLineIdx(&s, lend, &v))
+        errexit("Line %zu of file %s does not have a second vertex.\n", lineno, argv[1]);
+      if (u < 1 || v < 1 || u >= COLTAG || v >= COLTAG)
+        errexit("Line %zu of file %s has an invalid vertex id.\n", lineno, argv[1]);
+      nlines++;
+
+      if (bipartite) {
+        nrows = gk_max(nrows, u);
+        ncols = gk_max(ncols, v);
+        v = COLTAG + v-1;
+      }
+      else {
+        nvtxs = gk_max(nvtxs, gk_max(u, v));
+        if (u == v)
+          continue;
+        v--;
+      }
+      u--;
+
+      if (nedges+2 > maxedges) {
+        nedges = UniqueEdges(nedges, edges);
+        if (nedges+2 > maxedges/2) {
+          SpillEdgeRun(argv[2], nruns++, nedges, edges);
+          nedges = 0;
+        }
+      }
+
+      edges[nedges].u   = u;
+      edges[nedges++].v = v;
+      edges[nedges].u   = v;
+      edges[nedges++].v = u;
+    }
+
+    len = end - eol;
+    memmove(buf, eol, len);
+  } while (nread > 0);
+
+  gk_fclose(fpin);
+
+  if (nlines == 0)
+    errexit("File %s does not have any edges.\n", argv[1]);
+
+  nedges = UniqueEdges(nedges, edges);
+  if (nruns > 0) {
+    SpillEdgeRun(argv[2], nruns++, nedges, edges);
+    nedges = 0;
+  }
+
+  gk_stopcputimer(iotimer);
+
+  /*----------------------------------------------------------------------
+   * Merge the runs into the output file
+   *---------------------------------------------------------------------*/
+  gk_startcputimer(mergetimer);
+
+  if (bipartite)
+    nvtxs = nrows + ncols;
+  else
+    nrows = ncols = -1;
+
+  if (nruns == 0)
+    WriteEdgeRuns(argv[2], 0, nedges, edges, nvtxs, nrows, ncols, &nedges);
+  else
+    WriteEdgeRuns(argv[2], nruns, maxedges, edges, nvtxs, nrows, ncols, &nedges);
+
+  gk_stopcputimer(mergetimer);
+
+  printf("  Name: %s, #Vertices: %"PRIDX", #Edges: %zu, #Lines: %zu, #Runs: %"PRIDX"\n",
+      argv[1], nvtxs, nedges/2, nlines, nruns);
+  if (bipartite)
+    printf("  #Rows: %"PRIDX", #Columns: %"PRIDX"\n", nrows, ncols);
+  printf("  Reading: %7.3f sec, Merging: %7.3f sec\n",
+      gk_getcputimer(iotimer), gk_getcputimer(mergetimer));
+
+  gk_free((void **)&edges, &buf, LTERM);
+
+  return 0;
+}
+
+
+/*************************************************************************/
+/*! This function sorts the edges in increasing (u, v) order */
+/*************************************************************************/
+void SortEdges(size_t n, edge_t *edges)
+{
+  GK_MKQSORT(edge_t, edges, n, edge_lt);
+}
+
+
+/*************************************************************************/
+/*! This function sorts the edges and removes the duplicate ones. It
+    returns the # of edges that are left. */
+/*************************************************************************/
+size_t UniqueEdges(size_t n, edge_t *edges)
+{
+  size_t i, j;
+
+  if (n == 0)
+    return 0;
+
+  SortEdges(n, edges);
+
+  for (j=0, i=1; i<n; i++) {
+    if (edges[i].u != edges[j].u || edges[i].v != edges[j].v)
+      edges[++j] = edges[i];
+  }
+
+  return j+1;
+}
+
+
+/*************************************************************************/
+/*! This function writes the sorted edges to the run file irun */
+/*************************************************************************/
+void SpillEdgeRun(char *fname, idx_t irun, size_t n, edge_t *edges)
+{
+  char filename[MAXLINE];
+  FILE *fpout;
+
+  sprintf(filename, "%s.run.%"PRIDX, fname, irun);
+
+  fpout = gk_fopen(filename, "wb", __func__);
+  if (fwrite(edges, sizeof(edge_t), n, fpout) != n)
+    errexit("Failed to write file %s\n", filename);
+  gk_fclose(fpout);
+}
+
+
+/*************************************************************************/
+/*! This function returns the next edge of a run, refilling its buffer
+    from the run file when needed. It returns 0 once the run is over. */
+/*************************************************************************/
+int NextRunEdge(edgerun_t *run, edge_t *r_edge)
+{
+  if (run->pos == run->len) {
+    if (run->fpin == NULL)
+      return 0;
+    run->len = fread(run->buf, sizeof(edge_t), run->size, run->fpin);
+    run->pos = 0;
+    if (run->len == 0)
+      return 0;
+  }
+
+  *r_edge = run->buf[run->pos++];
+  return 1;
+}
+
+
+/*************************************************************************/
+/*! This function merges the nruns sorted runs into the binary CSR graph
+    file fname. The edges array, of size n, is split among the read
+    buffers of the runs, or, if nruns is 0, it holds the only run.
+
+    adjncy is written by one stream after space for the header and xadj,
+    while a second stream fills in xadj and finally the header, so only
+    the run buffers are kept in memory. The total # of adjacencies is
+    returned in r_nedges. */
+/*************************************************************************/
+void WriteEdgeRuns(char *fname, idx_t nruns, size_t n, edge_t *edges, idx_t nvtxs,
+         idx_t nrows, idx_t ncols, size_t *r_nedges)
+{
+  idx_t i, j, k, nheap, x, cur;
+  idx_t *heap;
+  size_t nedges;
+  edgerun_t *runs;
+  edge_t *heads, last;
+  binhdr_t hdr;
+  FILE *fpxadj, *fpadj;
+  char filename[MAXLINE];
+
+  /* a single run is merged from memory */
+  if (nruns == 0) {
+    nruns = 1;
+    runs = (edgerun_t *)gk_malloc(sizeof(edgerun_t), "WriteEdgeRuns: runs");
+    runs[0].fpin = NULL;
+    runs[0].buf  = edges;
+    runs[0].size = runs[0].len = n;
+    runs[0].pos  = 0;
+  }
+  else {
+    if (n/nruns == 0)
+      errexit("There are too many runs, use a larger -mem.\n");
+    runs = (edgerun_t *)gk_malloc(nruns*sizeof(edgerun_t), "WriteEdgeRuns: runs");
+    for (i=0; i<nruns; i++) {
+      sprintf(filename, "%s.run.%"PRIDX, fname, i);
+      runs[i].fpin = gk_fopen(filename, "rb", __func__);
+      runs[i].buf  = edges + i*(n/nruns);
+      runs[i].size = n/nruns;
+      runs[i].len  = runs[i].pos = 0;
+    }
+  }
+
+  /* set up the output file, its header is written last */
+  memset((void *)&hdr, 0, sizeof(binhdr_t));
+  memcpy(hdr.magic, BINGRAPH_MAGIC, 8);
+  hdr.version  = BINGRAPH_VERSION;
+  hdr.idxwidth = 8*sizeof(idx_t);
+  hdr.nvtxs    = nvtxs;
+  hdr.nrows    = nrows;
+  hdr.ncols    = ncols;
+
+  fpadj = gk_fopen(fname, "wb", __func__);
+  for (x=0, i=0; i<nvtxs+1+(idx_t)(sizeof(binhdr_t)/sizeof(idx_t)); i++) {
+    if (fwrite(&x, sizeof(idx_t), 1, fpadj) != 1)
+      errexit("Failed to write file %s\n", fname);
+  }
+  fflush(fpadj);
+
+  fpxadj = gk_fopen(fname, "r+b", __func__);
+  if (fwrite(&hdr, sizeof(binhdr_t), 1, fpxadj) != 1)
+    errexit("Failed to write file %s\n", fname);
+
+  /* a heap of the runs on their next edges */
+  heads = (edge_t *)gk_malloc(nruns*sizeof(edge_t), "WriteEdgeRuns: heads");
+  heap  = imalloc(nruns, "WriteEdgeRuns: heap");
+  for (nheap=0, i=0; i<nruns; i++) {
+    if (!NextRunEdge(runs+i, heads+i))
+      continue;
+    for (j=nheap++; j>0 && edge_lt(heads+i, heads+heap[(j-1)/2]); j=(j-1)/2)
+      heap[j] = heap[(j-1)/2];
+    heap[j] = i;
+  }
+
+  nedges = 0;
+  cur    = 0;
+  last.u = last.v = -1;
+  if (fwrite(&nedges, sizeof(idx_t), 1, fpxadj) != 1)
+    errexit("Failed to write file %s\n", fname);
+
+  while (nheap > 0) {
+    i = heap[0];
+
+    if (heads[i].u != last.u || heads[i].v != last.v) {
+      last = heads[i];
+
+      /* the columns of a bipartite graph are numbered after its rows */
+      x = (last.u >= COLTAG ? nrows + last.u-COLTAG : last.u);
+      for (; cur<x; cur++) {
+        if (fwrite(&nedges, sizeof(idx_t), 1, fpxadj) != 1)
+          errexit("Failed to write file %s\n", fname);
+      }
+
+      x = (last.v >= COLTAG ? nrows + last.v-COLTAG : last.v);
+      if (fwrite(&x, sizeof(idx_t), 1, fpadj) != 1)
+        errexit("Failed to write file %s\n", fname);
+      nedges++;
+    }
+
+    /* sift down the run with its next edge, or the last run of the heap */
+    if (!NextRunEdge(runs+i, heads+i))
+      i = heap[--nheap];
+    for (j=0; (k=2*j+1)<nheap; j=k) {
+      if (k+1 < nheap && edge_lt(heads+heap[k+1], heads+heap[k]))
+        k++;
+      if (!edge_lt(heads+heap[k], heads+i))
+        break;
+      heap[j] = heap[k];
+    }
+    heap[j] = i;
+  }
+
+  for (; cur<nvtxs; cur++) {
+    if (fwrite(&nedges, sizeof(idx_t), 1, fpxadj) != 1)
+      errexit("Failed to write file %s\n", fname);
+  }
+
+  hdr.nedges = nedges;
+  rewind(fpxadj);
+  if (fwrite(&hdr, sizeof(binhdr_t), 1, fpxadj) != 1)
+    errexit("Failed to write file %s\n", fname);
+
+  gk_fclose(fpxadj);
+  gk_fclose(fpadj);
+
+  for (i=0; i<nruns; i++) {
+    if (runs[i].fpin == NULL)
+      continue;
+    gk_fclose(runs[i].fpin);
+    sprintf(filename, "%s.run.%"PRIDX, fname, i);
+    remove(filename);
+  }
+
+  gk_free((void **)&runs, &heads, &heap, LTERM);
+
+  *r_nedges = nedges;
+}
@@ -0,0 +1,64 @@
+/*
+ * graph2bin.c
+ *
+ * This file converts a graph into the binary CSR graph format
+ *
+ */
+
+#include "metisbin.h"
+
+
+
+/*************************************************************************/
+/*! Let entry point of the converter */
+/*************************************************************************/
+int main(int argc, char *argv[])
+{
+  graph_t *graph;
+  idx_t nrows = -1, ncols = -1;
+  int varint = 0;
+  params_t params;
+
+  if (argc > 1 && strcmp(argv[1], "-varint") == 0) {
+    varint = 1;
+    argc--;
+    argv++;
+  }
+
+  if (argc != 3 && argc != 5) {
+    printf("Usage: %s [-varint] <GraphFile> <BinaryFile> [<nrows> <ncols>]\n", argv[0]);
+    printf("  nrows and ncols are stored for the bipartite graphs used by rbbdf.\n");
+    printf("  -varint stores the arrays delta-varint encoded.\n");
+    exit(0);
+  }
+
+  if (argc == 5) {
+    nrows = (idx_t)atoll(argv[3]);
+    ncols = (idx_t)atoll(argv[4]);
+  }
+
+  memset((void *)&params, 0, sizeof(params_t));
+  params.filename = gk_strdup(argv[1]);
+
+  gk_startcputimer(params.iotimer);
+  graph = ReadGraph(&params);
+  gk_stopcputimer(params.iotimer);
+
+  if (nrows != -1 && nrows + ncols != graph->nvtxs)
+    errexit("nrows + ncols = %"PRIDX" differs from the %"PRIDX" vertices of the graph.\n",
+        nrows + ncols, graph->nvtxs);
+
+  gk_startcputimer(params.parttimer);
+  WriteBinaryGraph(graph, nrows, ncols, varint, argv[2]);
+  gk_stopcputimer(params.parttimer);
+
+  printf("  Name: %s, #Vertices: %"PRIDX", #Edges: %"PRIDX"\n", 
+      params.filename, graph->nvtxs, graph->nedges/2);
+  printf("  Reading: %7.3f sec, Writing: %7.3f sec\n", 
+      gk_getcputimer(params.iotimer), gk_getcputimer(params.parttimer));
+
+  FreeGraph(&graph);
+  gk_free((void **)&params.filename, LTERM);
+
+  return 0;
+}
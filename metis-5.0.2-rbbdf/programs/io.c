@@ -14,18 +14,31 @@
 
 #include "metisbin.h"
 
+#if !defined(COMPILER_MSC)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 
 /*************************************************************************/
-/*! This function reads in a sparse graph */
+/*! This function reads in a sparse graph. 
+
+    The file is mapped into memory and parsed in parallel chunks of lines,
+    one per OpenMP thread: the vertex lines of each chunk are counted, 
+    the degrees of its vertices are counted into xadj, which is then 
+    turned into a CSR index, and finally adjncy and the weights are filled
+    in concurrently. The number of threads is set by OMP_NUM_THREADS. */
 /*************************************************************************/
 graph_t *ReadGraph(params_t *params)
 {
-  idx_t i, j, k, l, fmt, ncon, nfields, readew, readvw, readvs, edge, ewgt;
-  idx_t *xadj, *adjncy, *vwgt, *adjwgt, *vsize;
-  char *line=NULL, fmtstr[256], *curstr, *newstr;
-  size_t lnlen=0;
-  FILE *fpin;
+  idx_t i, c, fmt, ncon, nfields, nchunks, readew, readvw, readvs;
+  idx_t *xadj, *nlines;
+  char *data, *curstr, *body, *end, *line, **bounds, fmtstr[256];
+  size_t size;
   graph_t *graph;
 
 
@@ -34,17 +47,23 @@ graph_t *ReadGraph(params_t *params)
 
   graph = CreateGraph();
 
-  fpin = gk_fopen(params->filename, "r", "ReadGRaph: Graph");
+  data = (char *)MapFile(params->filename, &size);
+  end  = data + size;
 
   /* Skip comment lines until you get to the first valid line */
-  do {
-    if (gk_getline(&line, &lnlen, fpin) == -1) 
-      errexit("Premature end of input file: file: %s\n", params->filename);
-  } while (line[0] == '%');
+  for (curstr=data; curstr<end && curstr[0]=='%'; curstr=NextLine(curstr, end));
+  if (curstr == end)
+    errexit("Premature end of input file: file: %s\n", params->filename);
+  body = NextLine(curstr, end);
+
+  line = gk_cmalloc(body-curstr+1, "ReadGraph: line");
+  memcpy(line, curstr, body-curstr);
+  line[body-curstr] = '\0';
 
   fmt = ncon = 0;
   nfields = sscanf(line, "%"SCIDX" %"SCIDX" %"SCIDX" %"SCIDX, 
                 &(graph->nvtxs), &(graph->nedges), &fmt, &ncon);
+  gk_free((void **)&line, LTERM);
 
   if (nfields < 2) 
     errexit("The input file does not specify the number of vertices and edges.\n");
@@ -74,113 +93,832 @@ graph_t *ReadGraph(params_t *params)
   graph->nedges *=2;
   ncon = graph->ncon = (ncon == 0 ? 1 : ncon);
 
-  xadj   = graph->xadj   = ismalloc(graph->nvtxs+1, 0, "ReadGraph: xadj");
-  adjncy = graph->adjncy = imalloc(graph->nedges, "ReadGraph: adjncy");
-  vwgt   = graph->vwgt   = ismalloc(ncon*graph->nvtxs, 1, "ReadGraph: vwgt");
-  adjwgt = graph->adjwgt = ismalloc(graph->nedges, 1, "ReadGraph: adjwgt");
-  vsize  = graph->vsize  = ismalloc(graph->nvtxs, 1, "ReadGraph: vsize");
+  xadj          = graph->xadj   = ismalloc(graph->nvtxs+1, 0, "ReadGraph: xadj");
+  graph->vwgt   = ismalloc(ncon*graph->nvtxs, 1, "ReadGraph: vwgt");
+  graph->vsize  = ismalloc(graph->nvtxs, 1, "ReadGraph: vsize");
+
+  /*----------------------------------------------------------------------
+   * Split the lines of the sparse graph into chunks
+   *---------------------------------------------------------------------*/
+#if defined(__OPENMP__)
+  nchunks = gk_max(1, gk_min(omp_get_max_threads(), (end-body)/(1<<16)));
+#else
+  nchunks = 1;
+#endif
+  bounds = (char **)gk_malloc((nchunks+1)*sizeof(char *), "ReadGraph: bounds");
+  nlines = ismalloc(nchunks+1, 0, "ReadGraph: nlines");
+
+  bounds[0] = body;
+  for (c=1; c<nchunks; c++) {
+    curstr = gk_max(bounds[c-1], body + c*((end-body)/nchunks));
+    if (curstr > body && curstr[-1] != '\n')
+      curstr = NextLine(curstr, end);
+    bounds[c] = curstr;
+  }
+  bounds[nchunks] = end;
+
+  /* Count the vertex lines of each chunk to get the first vertex of each */
+  #pragma omp parallel for schedule(static, 1)
+  for (c=0; c<nchunks; c++) 
+    nlines[c+1] = CountGraphLines(bounds[c], bounds[c+1]);
+  for (c=0; c<nchunks; c++)
+    nlines[c+1] += nlines[c];
+
+  if (nlines[nchunks] < graph->nvtxs)
+    errexit("Premature end of input file while reading vertex %"PRIDX".\n", nlines[nchunks]+1);
 
   /*----------------------------------------------------------------------
    * Read the sparse graph file
    *---------------------------------------------------------------------*/
-  for (xadj[0]=0, k=0, i=0; i<graph->nvtxs; i++) {
-    do {
-      if (gk_getline(&line, &lnlen, fpin) == -1) 
-        errexit("Premature end of input file while reading vertex %"PRIDX".\n", i+1);
-    } while (line[0] == '%');
+  #pragma omp parallel for schedule(static, 1)
+  for (c=0; c<nchunks; c++) 
+    CountGraphChunk(graph, bounds[c], bounds[c+1], nlines[c], readvs, readvw, readew);
 
-    curstr = line;
-    newstr = NULL;
+  MAKECSR(i, graph->nvtxs, xadj);
+
+  /* the adjacency lists are read in full before their number is checked */
+  graph->adjncy = imalloc(gk_max(xadj[graph->nvtxs], graph->nedges), "ReadGraph: adjncy");
+  graph->adjwgt = ismalloc(gk_max(xadj[graph->nvtxs], graph->nedges), 1, "ReadGraph: adjwgt");
+
+  #pragma omp parallel for schedule(static, 1)
+  for (c=0; c<nchunks; c++) 
+    ReadGraphChunk(graph, bounds[c], bounds[c+1], nlines[c], readvs, readvw, readew);
+
+  if (xadj[graph->nvtxs] > graph->nedges)
+    errexit("There are more edges in the file than the %"PRIDX" specified.\n", 
+        graph->nedges/2);
+
+  if (xadj[graph->nvtxs] != graph->nedges) {
+    printf("------------------------------------------------------------------------------\n");
+    printf("***  I detected an error in your input file  ***\n\n");
+    printf("In the first line of the file, you specified that the graph contained\n"
+           "%"PRIDX" edges. However, I only found %"PRIDX" edges in the file.\n", 
+           graph->nedges/2, xadj[graph->nvtxs]/2);
+    if (2*xadj[graph->nvtxs] == graph->nedges) {
+      printf("\n *> I detected that you specified twice the number of edges that you have in\n");
+      printf("    the file. Remember that the number of edges specified in the first line\n");
+      printf("    counts each edge between vertices v and u only once.\n\n");
+    }
+    printf("Please specify the correct number of edges in the first line of the file.\n");
+    printf("------------------------------------------------------------------------------\n");
+    exit(0);
+  }
+
+  UnmapFile(data, size);
+  gk_free((void **)&bounds, &nlines, LTERM);
+
+  return graph;
+}
+
+
+/*************************************************************************/
+/*! This function returns the start of the line after the one at s */
+/*************************************************************************/
+char *NextLine(char *s, char *end)
+{
+  s = memchr(s, '\n', end-s);
+
+  return (s == NULL ? end : s+1);
+}
+
+
+/*************************************************************************/
+/*! This function counts the non-comment lines in [s, end) */
+/*************************************************************************/
+idx_t CountGraphLines(char *s, char *end)
+{
+  idx_t nlines=0;
+
+  for (; s<end; s=NextLine(s, end)) {
+    if (s[0] != '%')
+      nlines++;
+  }
+
+  return nlines;
+}
+
+
+/*************************************************************************/
+/*! This function stores the degrees of the vertices whose lines are in 
+    [s, end) into xadj, the first of them being vertex v. The 
+    degrees are derived from the number of numeric tokens of each line,
+    without converting them. */
+/*************************************************************************/
+void CountGraphChunk(graph_t *graph, char *s, char *end, idx_t v, idx_t readvs, 
+         idx_t readvw, idx_t readew)
+{
+  idx_t ntokens, nskip;
+  char *eol;
+
+  nskip = readvs + readvw*graph->ncon;
+
+  for (; s<end && v<graph->nvtxs; s=eol) {
+    eol = NextLine(s, end);
+    if (s[0] == '%')
+      continue;
+
+    /* a line ends at its first token that is not a number, as in ReadLineIdx() */
+    for (ntokens=0; s<eol; ) {
+      for (; s<eol && isspace((int)*s); s++);
+      if (s == eol || !(isdigit((int)*s) || 
+            ((*s == '-' || *s == '+') && s+1 < eol && isdigit((int)s[1]))))
+        break;
+      ntokens++;
+      for (; s<eol && !isspace((int)*s); s++);
+    }
+
+    /* an edge without its weight is counted, so that ReadGraphChunk()
+       reports it */
+    ntokens -= nskip;
+    graph->xadj[v++] = (ntokens > 0 ? (readew ? (ntokens+1)/2 : ntokens) : 0);
+  }
+}
+
+
+/*************************************************************************/
+/*! This function reads the vertices whose lines are in [s, end), the 
+    first of them being vertex v, into the arrays of graph. */
+/*************************************************************************/
+void ReadGraphChunk(graph_t *graph, char *s, char *end, idx_t v, idx_t readvs, 
+         idx_t readvw, idx_t readew)
+{
+  idx_t i, l, k, kend, ncon, edge, ewgt;
+  char *eol, *curstr;
+
+  ncon = graph->ncon;
+
+  for (; s<end && v<graph->nvtxs; s=eol) {
+    eol = NextLine(s, end);
+    if (s[0] == '%')
+      continue;
+
+    i      = v++;
+    curstr = s;
+    k      = graph->xadj[i];
+    kend   = graph->xadj[i+1];
 
     /* Read vertex sizes */
     if (readvs) {
-      vsize[i] = strtoidx(curstr, &newstr, 10);
-      if (newstr == curstr)
+      if (!ReadLineIdx(&curstr, eol, &graph->vsize[i]))
         errexit("The line for vertex %"PRIDX" does not have vsize information\n", i+1);
-      if (vsize[i] < 0)
+      if (graph->vsize[i] < 0)
         errexit("The size for vertex %"PRIDX" must be >= 0\n", i+1);
-      curstr = newstr;
     }
 
 
     /* Read vertex weights */
     if (readvw) {
       for (l=0; l<ncon; l++) {
-        vwgt[i*ncon+l] = strtoidx(curstr, &newstr, 10);
-        if (newstr == curstr)
+        if (!ReadLineIdx(&curstr, eol, &graph->vwgt[i*ncon+l]))
           errexit("The line for vertex %"PRIDX" does not have enough weights "
                   "for the %"PRIDX" constraints.\n", i+1, ncon);
-        if (vwgt[i*ncon+l] < 0)
+        if (graph->vwgt[i*ncon+l] < 0)
           errexit("The weight vertex %"PRIDX" and constraint %"PRIDX" must be >= 0\n", i+1, l);
-        curstr = newstr;
       }
     }
 
-    while (1) {
-      edge = strtoidx(curstr, &newstr, 10);
-      if (newstr == curstr)
+    while (k < kend) {
+      if (!ReadLineIdx(&curstr, eol, &edge))
         break; /* End of line */
-      curstr = newstr;
 
       if (edge < 1 || edge > graph->nvtxs)
         errexit("Edge %"PRIDX" for vertex %"PRIDX" is out of bounds\n", edge, i+1);
 
       ewgt = 1;
       if (readew) {
-        ewgt = strtoidx(curstr, &newstr, 10);
-        if (newstr == curstr)
+        if (!ReadLineIdx(&curstr, eol, &ewgt))
           errexit("Premature end of line for vertex %"PRIDX"\n", i+1);
         if (ewgt <= 0)
           errexit("The weight (%"PRIDX") for edge (%"PRIDX", %"PRIDX") must be positive.\n", 
               ewgt, i+1, edge);
-        curstr = newstr;
       }
 
-      if (k == graph->nedges)
-        errexit("There are more edges in the file than the %"PRIDX" specified.\n", 
-            graph->nedges/2);
-
-      adjncy[k] = edge-1;
-      adjwgt[k] = ewgt;
+      graph->adjncy[k] = edge-1;
+      graph->adjwgt[k] = ewgt;
       k++;
     } 
-    xadj[i+1] = k;
+
+    /* a token that starts like a number but is not one */
+    if (k != kend || ReadLineIdx(&curstr, eol, &edge))
+      errexit("The line for vertex %"PRIDX" contains an invalid token.\n", i+1);
   }
+}
+
+
+/*************************************************************************/
+/*! This function reads the next number of the line [*r_s, eol) into 
+    *r_val and advances *r_s past it. It returns 0 at the end of the line
+    or if the next token is not a number. Unlike strtoidx(), it never 
+    crosses the end of the line, and it only accepts decimal numbers, 
+    which also makes it quite faster. */
+/*************************************************************************/
+int ReadLineIdx(char **r_s, char *eol, idx_t *r_val)
+{
+  idx_t val=0, neg=0;
+  char *s;
+
+  for (s=*r_s; s<eol && isspace((int)*s); s++);
+
+  if (s < eol && (*s == '-' || *s == '+')) 
+    neg = (*s++ == '-');
+  if (s == eol || !isdigit((int)*s))
+    return 0;
+
+  for (; s<eol && isdigit((int)*s); s++)
+    val = 10*val + (*s - '0');
+
+  *r_val = (neg ? -val : val);
+  *r_s   = s;
+  return 1;
+}
+
+
+/*************************************************************************/
+/*! This function returns 1 if filename is a binary CSR graph file */
+/*************************************************************************/
+int IsBinaryGraph(char *filename)
+{
+  char magic[8];
+  size_t nread;
+  FILE *fpin;
+
+  if (!gk_fexists(filename)) 
+    return 0;
+
+  fpin = gk_fopen(filename, "rb", __func__);
+  nread = fread(magic, 1, 8, fpin);
   gk_fclose(fpin);
 
-  if (k != graph->nedges) {
-    printf("------------------------------------------------------------------------------\n");
-    printf("***  I detected an error in your input file  ***\n\n");
-    printf("In the first line of the file, you specified that the graph contained\n"
-           "%"PRIDX" edges. However, I only found %"PRIDX" edges in the file.\n", 
-           graph->nedges/2, k/2);
-    if (2*k == graph->nedges) {
-      printf("\n *> I detected that you specified twice the number of edges that you have in\n");
-      printf("    the file. Remember that the number of edges specified in the first line\n");
-      printf("    counts each edge between vertices v and u only once.\n\n");
+  return (nread == 8 && strncmp(magic, BINGRAPH_MAGIC, 8) == 0);
+}
+
+
+/*************************************************************************/
+/*! This function reads in a binary CSR graph file written by 
+    WriteBinaryGraph(). The file is mapped into memory and xadj/adjncy 
+    (and the weights if stored) point straight into the mapping, so they
+    must not be freed. The mapping is kept in params and released by 
+    FreeGraphMapping(). The weights that are not stored are left NULL.
+
+    Only the header and the array bounds are checked, the adjacency 
+    lists are trusted as they are.
+
+    The arrays of a BINGRAPH_VARINT file are decoded into memory of their
+    own instead, and the file is unmapped right away.
+
+    If params->nrows/ncols are not set, they are taken from the header. */
+/*************************************************************************/
+graph_t *ReadBinaryGraph(params_t *params)
+{
+  size_t mapsize, expsize;
+  binhdr_t *hdr;
+  idx_t *data;
+  graph_t *graph;
+
+  if (!gk_fexists(params->filename)) 
+    errexit("File %s does not exist!\n", params->filename);
+
+  params->mapping = MapFile(params->filename, &mapsize);
+  if (mapsize < sizeof(binhdr_t))
+    errexit("Premature end of input file: file: %s\n", params->filename);
+  params->mapsize = mapsize;
+
+  hdr = (binhdr_t *)params->mapping;
+  if (strncmp(hdr->magic, BINGRAPH_MAGIC, 8) != 0)
+    errexit("File %s is not a binary graph file.\n", params->filename);
+  if (hdr->version != BINGRAPH_VERSION)
+    errexit("Cannot read version %d of the binary graph format [file: %s]!\n", 
+        (int)hdr->version, params->filename);
+  if (hdr->idxwidth != 8*sizeof(idx_t))
+    errexit("File %s stores %d bit indices, but idx_t is %d bits.\n", 
+        params->filename, (int)hdr->idxwidth, (int)(8*sizeof(idx_t)));
+  if (hdr->nvtxs <= 0 || hdr->nedges <= 0) 
+    errexit("The supplied nvtxs:%"PRId64" and nedges:%"PRId64" must be positive.\n", 
+        hdr->nvtxs, hdr->nedges/2);
+
+  if (hdr->flags&BINGRAPH_VARINT)
+    return ReadVarintGraph(params);
+
+  expsize = sizeof(binhdr_t) + sizeof(idx_t)*(hdr->nvtxs+1 + hdr->nedges
+              + (hdr->flags&BINGRAPH_VWGT ? hdr->nvtxs : 0) 
+              + (hdr->flags&BINGRAPH_ADJWGT ? hdr->nedges : 0));
+  if (mapsize != expsize)
+    errexit("The size of file %s is %zu bytes, but its header asks for %zu.\n", 
+        params->filename, mapsize, expsize);
+
+  graph = CreateGraph();
+
+  graph->nvtxs  = hdr->nvtxs;
+  graph->nedges = hdr->nedges;
+  graph->ncon   = 1;
+
+  data = (idx_t *)(hdr+1);
+  graph->xadj   = data;  data += graph->nvtxs+1;
+  graph->adjncy = data;  data += graph->nedges;
+  if (hdr->flags&BINGRAPH_VWGT) {
+    graph->vwgt = data;  data += graph->nvtxs;
+  }
+  if (hdr->flags&BINGRAPH_ADJWGT)
+    graph->adjwgt = data;
+
+  graph->free_xadj   = 0;
+  graph->free_adjncy = 0;
+  graph->free_vwgt   = 0;
+  graph->free_adjwgt = 0;
+  graph->free_vsize  = 0;
+
+  if (graph->xadj[0] != 0 || graph->xadj[graph->nvtxs] != graph->nedges)
+    errexit("The xadj of file %s does not match its %"PRIDX" adjacencies.\n", 
+        params->filename, graph->nedges);
+
+  if (params->nrows == -1 && params->ncols == -1) {
+    params->nrows = hdr->nrows;
+    params->ncols = hdr->ncols;
+  }
+
+  return graph;
+}
+
+
+/*************************************************************************/
+/*! This function reads in the delta-varint encoded arrays of a binary 
+    graph file whose header has been checked by ReadBinaryGraph() */
+/*************************************************************************/
+graph_t *ReadVarintGraph(params_t *params)
+{
+  binhdr_t *hdr;
+  char *s, *end;
+  graph_t *graph;
+
+  hdr = (binhdr_t *)params->mapping;
+  end = (char *)params->mapping + params->mapsize;
+
+  if (hdr->fsize <= 0)
+    errexit("The frame size %d of file %s must be positive.\n", 
+        (int)hdr->fsize, params->filename);
+
+  graph = CreateGraph();
+
+  graph->nvtxs  = hdr->nvtxs;
+  graph->nedges = hdr->nedges;
+  graph->ncon   = 1;
+
+  graph->xadj   = imalloc(graph->nvtxs+1, "ReadVarintGraph: xadj");
+  graph->adjncy = imalloc(graph->nedges, "ReadVarintGraph: adjncy");
+
+  s = (char *)(hdr+1);
+  s = ReadVarintArray(s, end, graph->nvtxs+1, hdr->fsize, graph->xadj, params->filename);
+  s = ReadVarintArray(s, end, graph->nedges, hdr->fsize, graph->adjncy, params->filename);
+  if (hdr->flags&BINGRAPH_VWGT) {
+    graph->vwgt = imalloc(graph->nvtxs, "ReadVarintGraph: vwgt");
+    s = ReadVarintArray(s, end, graph->nvtxs, hdr->fsize, graph->vwgt, params->filename);
+  }
+  if (hdr->flags&BINGRAPH_ADJWGT) {
+    graph->adjwgt = imalloc(graph->nedges, "ReadVarintGraph: adjwgt");
+    s = ReadVarintArray(s, end, graph->nedges, hdr->fsize, graph->adjwgt, params->filename);
+  }
+  if (s != end)
+    errexit("File %s has %zu bytes past its arrays.\n", params->filename, (size_t)(end-s));
+
+  if (graph->xadj[0] != 0 || graph->xadj[graph->nvtxs] != graph->nedges)
+    errexit("The xadj of file %s does not match its %"PRIDX" adjacencies.\n", 
+        params->filename, graph->nedges);
+
+  if (params->nrows == -1 && params->ncols == -1) {
+    params->nrows = hdr->nrows;
+    params->ncols = hdr->ncols;
+  }
+
+  FreeGraphMapping(params);
+
+  return graph;
+}
+
+
+/*************************************************************************/
+/*! This function decodes an array of n values written by 
+    WriteVarintArray() that starts at s, and returns the position after
+    it. end is the end of the input. */
+/*************************************************************************/
+char *ReadVarintArray(char *s, char *end, idx_t n, idx_t fsize, idx_t *x, char *filename)
+{
+  idx_t nframes;
+  int64_t *fptr;
+  size_t nbytes;
+
+  nframes = GK_VNFRAMES(n, fsize);
+
+  if ((size_t)(end-s) < (nframes+1)*sizeof(int64_t))
+    errexit("Premature end of input file: file: %s\n", filename);
+  fptr = (int64_t *)s;
+  s += (nframes+1)*sizeof(int64_t);
+
+  if (fptr[0] != 0 || fptr[nframes] < 0 || (size_t)(end-s) < (size_t)fptr[nframes])
+    errexit("Premature end of input file: file: %s\n", filename);
+  nbytes = fptr[nframes];
+
+  if (!ivdecodeframes(n, fsize, (unsigned char *)s, fptr, x))
+    errexit("File %s has a corrupted varint array.\n", filename);
+
+  /* the arrays start at multiples of 8 bytes */
+  nbytes += (8 - nbytes%8)%8;
+  return s + gk_min(nbytes, (size_t)(end-s));
+}
+
+
+/*************************************************************************/
+/*! This function releases the mapping set up by ReadBinaryGraph() */
+/*************************************************************************/
+void FreeGraphMapping(params_t *params)
+{
+  if (params->mapping == NULL)
+    return;
+
+  UnmapFile(params->mapping, params->mapsize);
+  params->mapping = NULL;
+  params->mapsize = 0;
+}
+
+
+/*************************************************************************/
+/*! This function maps a file into memory and returns its size in r_size.
+    The mapping is private and writable, its pages are only copied if 
+    written to. Without mmap the file is read into one buffer instead. */
+/*************************************************************************/
+void *MapFile(char *filename, size_t *r_size)
+{
+  void *map;
+  size_t size;
+#if !defined(COMPILER_MSC)
+  int fd;
+  struct stat st;
+
+  if ((fd = open(filename, O_RDONLY)) == -1)
+    errexit("Failed to open file %s: %s\n", filename, strerror(errno));
+  if (fstat(fd, &st) == -1)
+    errexit("Failed to stat file %s: %s\n", filename, strerror(errno));
+  size = (size_t)st.st_size;
+  if (size == 0)
+    errexit("Premature end of input file: file: %s\n", filename);
+
+  map = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    errexit("Failed to map file %s: %s\n", filename, strerror(errno));
+  close(fd);
+#else
+  FILE *fpin;
+
+  size = gk_getfsize(filename);
+  if (size == 0)
+    errexit("Premature end of input file: file: %s\n", filename);
+  map = gk_malloc(size, "MapFile: map");
+  fpin = gk_fopen(filename, "rb", __func__);
+  if (fread(map, 1, size, fpin) != size)
+    errexit("Failed to read file %s\n", filename);
+  gk_fclose(fpin);
+#endif
+
+  *r_size = size;
+  return map;
+}
+
+
+/*************************************************************************/
+/*! This function releases a mapping set up by MapFile() */
+/*************************************************************************/
+void UnmapFile(void *map, size_t size)
+{
+#if !defined(COMPILER_MSC)
+  munmap(map, size);
+#else
+  gk_free((void **)&map, LTERM);
+#endif
+}
+
+
+/*************************************************************************/
+/*! This function reads in a .matrix file as a bipartite graph. The first
+    line is M N, the second line lists the row ids (1..M) of the following
+    lines, the third line the column ids (M+1..M+N) of their entries, and
+    each of the next M lines is a dense row of N zero/non-zero values.
+    The rows are vertices 0..M-1 and the columns M..M+N-1, as in the 
+    .graph files. params->nrows/ncols are set to M and N. */
+/*************************************************************************/
+graph_t *ReadMatrixGraph(params_t *params)
+{
+  idx_t i, j, nrows, ncols, npairs, maxpairs, val;
+  idx_t *rorder, *corder, *rows, *cols;
+  char *data, *end, *s, *eol, *curstr;
+  size_t size;
+  graph_t *graph;
+
+  if (!gk_fexists(params->filename)) 
+    errexit("File %s does not exist!\n", params->filename);
+
+  data = (char *)MapFile(params->filename, &size);
+  end  = data + size;
+
+  /* Skip comment lines until you get to the first valid line */
+  for (s=data; s<end && s[0]=='%'; s=NextLine(s, end));
+  eol = NextLine(s, end);
+  if (!ReadLineIdx(&s, eol, &nrows) || !ReadLineIdx(&s, eol, &ncols))
+    errexit("The input file does not specify the number of rows and columns.\n");
+  if (nrows <= 0 || ncols <= 0)
+    errexit("The supplied nrows:%"PRIDX" and ncols:%"PRIDX" must be positive.\n", nrows, ncols);
+
+  rorder = imalloc(nrows, "ReadMatrixGraph: rorder");
+  corder = imalloc(ncols, "ReadMatrixGraph: corder");
+
+  for (s=eol, eol=NextLine(s, end), i=0; i<nrows; i++) {
+    if (!ReadLineIdx(&s, eol, &rorder[i]))
+      errexit("The row order has fewer than %"PRIDX" rows.\n", nrows);
+    if (rorder[i] < 1 || rorder[i] > nrows)
+      errexit("Row %"PRIDX" of the row order is out of bounds\n", rorder[i]);
+  }
+  for (s=eol, eol=NextLine(s, end), j=0; j<ncols; j++) {
+    if (!ReadLineIdx(&s, eol, &corder[j]))
+      errexit("The column order has fewer than %"PRIDX" columns.\n", ncols);
+    if (corder[j] <= nrows || corder[j] > nrows+ncols)
+      errexit("Column %"PRIDX" of the column order is out of bounds\n", corder[j]);
+  }
+
+  /* collect the non-zeros, growing the arrays as needed */
+  maxpairs = gk_max(1024, (end-eol)/(2*ncols));
+  rows = imalloc(maxpairs, "ReadMatrixGraph: rows");
+  cols = imalloc(maxpairs, "ReadMatrixGraph: cols");
+
+  for (npairs=0, s=eol, i=0; i<nrows; i++) {
+    if (s == end)
+      errexit("Premature end of input file while reading row %"PRIDX".\n", i+1);
+    eol = NextLine(s, end);
+    for (curstr=s, j=0; j<ncols; j++) {
+      if (!ReadLineIdx(&curstr, eol, &val))
+        errexit("The line for row %"PRIDX" has fewer than %"PRIDX" values.\n", i+1, ncols);
+      if (val == 0)
+        continue;
+      if (npairs == maxpairs) {
+        maxpairs *= 2;
+        rows = irealloc(rows, maxpairs, "ReadMatrixGraph: rows");
+        cols = irealloc(cols, maxpairs, "ReadMatrixGraph: cols");
+      }
+      rows[npairs]   = rorder[i]-1;
+      cols[npairs++] = corder[j]-nrows-1;
     }
-    printf("Please specify the correct number of edges in the first line of the file.\n");
-    printf("------------------------------------------------------------------------------\n");
-    exit(0);
+    s = eol;
   }
 
-  gk_free((void *)&line, LTERM);
+  UnmapFile(data, size);
+
+  graph = BuildBiGraph(nrows, ncols, npairs, rows, cols);
+
+  SetBiGraphSize(params, nrows, ncols);
+
+  gk_free((void **)&rorder, &corder, &rows, &cols, LTERM);
 
   return graph;
 }
 
+
+/*************************************************************************/
+/*! This function reads in a file of user item [rating] triples, one per
+    line, as a bipartite graph with the users as rows and the items as
+    columns. The ids can be any non-negative numbers, they are remapped
+    to 0..nrows-1 and 0..ncols-1 in increasing order, and the original 
+    ids are kept in params->rowids/colids. The fields can be separated by
+    anything but digits, e.g., blanks, commas, or '::', and anything after
+    the item id, such as the rating, is ignored. The lines that do not 
+    start with a digit, such as comments and headers, are skipped.
+    params->nrows/ncols are set to the number of distinct users/items. */
+/*************************************************************************/
+graph_t *ReadTriplesGraph(params_t *params)
+{
+  idx_t nrows, ncols, npairs, maxpairs;
+  idx_t *rows, *cols;
+  char *data, *end, *s, *eol;
+  size_t size, lineno;
+  graph_t *graph;
+
+  if (!gk_fexists(params->filename)) 
+    errexit("File %s does not exist!\n", params->filename);
+
+  data = (char *)MapFile(params->filename, &size);
+  end  = data + size;
+
+  maxpairs = CountGraphLines(data, end);
+  rows = imalloc(maxpairs, "ReadTriplesGraph: rows");
+  cols = imalloc(maxpairs, "ReadTriplesGraph: cols");
+
+  for (npairs=0, lineno=1, s=data; s<end; s=eol, lineno++) {
+    eol = NextLine(s, end);
+
+    for (; s<eol && isspace((int)*s); s++);
+    if (s == eol || !isdigit((int)*s))
+      continue;
+
+    ReadLineIdx(&s, eol, &rows[npairs]);
+    for (; s<eol && !isdigit((int)*s); s++);
+    if (!ReadLineIdx(&s, eol, &cols[npairs]))
+      errexit("Line %zu of file %s does not have an item id.\n", lineno, params->filename);
+    npairs++;
+  }
+
+  UnmapFile(data, size);
+
+  if (npairs == 0)
+    errexit("File %s does not have any user item pairs.\n", params->filename);
+
+  params->rowids = RemapIds(npairs, rows, &nrows);
+  params->colids = RemapIds(npairs, cols, &ncols);
+
+  graph = BuildBiGraph(nrows, ncols, npairs, rows, cols);
+
+  SetBiGraphSize(params, nrows, ncols);
+
+  gk_free((void **)&rows, &cols, LTERM);
+
+  return graph;
+}
+
+
+/*************************************************************************/
+/*! This function renumbers the ids[0..n-1] to 0..nids-1 in increasing 
+    order of their values and returns the table of the nids original ids.
+    The ids are looked up in a dense table if they are not much larger 
+    than n, otherwise they are sorted. */
+/*************************************************************************/
+idx_t *RemapIds(idx_t n, idx_t *ids, idx_t *r_nids)
+{
+  idx_t i, nids, maxid;
+  idx_t *map, *table;
+  ikv_t *keys;
+
+  maxid = imax(n, ids);
+
+  if (maxid < 4*n) {
+    map = ismalloc(maxid+1, -1, "RemapIds: map");
+    for (i=0; i<n; i++)
+      map[ids[i]] = 0;
+    for (nids=0, i=0; i<=maxid; i++) {
+      if (map[i] == 0)
+        nids++;
+    }
+
+    table = imalloc(nids, "RemapIds: table");
+    for (nids=0, i=0; i<=maxid; i++) {
+      if (map[i] == 0) {
+        table[nids] = i;
+        map[i] = nids++;
+      }
+    }
+    for (i=0; i<n; i++)
+      ids[i] = map[ids[i]];
+
+    gk_free((void **)&map, LTERM);
+  }
+  else {
+    keys = ikvmalloc(n, "RemapIds: keys");
+    for (i=0; i<n; i++) {
+      keys[i].key = ids[i];
+      keys[i].val = i;
+    }
+    ikvsorti(n, keys);
+
+    for (nids=0, i=0; i<n; i++) {
+      if (i == 0 || keys[i].key != keys[i-1].key)
+        nids++;
+    }
+
+    table = imalloc(nids, "RemapIds: table");
+    for (nids=0, i=0; i<n; i++) {
+      if (i == 0 || keys[i].key != keys[i-1].key)
+        table[nids++] = keys[i].key;
+      ids[keys[i].val] = nids-1;
+    }
+
+    gk_free((void **)&keys, LTERM);
+  }
+
+  *r_nids = nids;
+
+  return table;
+}
+
+
+/*************************************************************************/
+/*! This function builds the symmetric graph of a bipartite graph from the
+    (rows[i], cols[i]) pairs of its non-zeros. The rows are vertices 
+    0..nrows-1 and the columns nrows..nrows+ncols-1. The pairs are bucketed
+    by counting sort, the duplicates are dropped, and the adjacency lists
+    come out sorted. The weights are left NULL, i.e., unit weights. */
+/*************************************************************************/
+graph_t *BuildBiGraph(idx_t nrows, idx_t ncols, idx_t npairs, idx_t *rows, idx_t *cols)
+{
+  idx_t i, j, k, c, nvtxs, nnz;
+  idx_t *rptr, *rind, *mark, *xadj, *adjncy;
+  graph_t *graph;
+
+  nvtxs = nrows + ncols;
+
+  /* bucket the columns of each row */
+  rptr = ismalloc(nrows+1, 0, "BuildBiGraph: rptr");
+  rind = imalloc(npairs, "BuildBiGraph: rind");
+  for (k=0; k<npairs; k++)
+    rptr[rows[k]]++;
+  MAKECSR(i, nrows, rptr);
+  for (k=0; k<npairs; k++)
+    rind[rptr[rows[k]]++] = cols[k];
+  SHIFTCSR(i, nrows, rptr);
+
+  /* drop the duplicate non-zeros */
+  mark = ismalloc(ncols, -1, "BuildBiGraph: mark");
+  for (nnz=0, i=0; i<nrows; i++) {
+    j = rptr[i];
+    rptr[i] = nnz;
+    for (; j<rptr[i+1]; j++) {
+      if (mark[rind[j]] != i) {
+        mark[rind[j]] = i;
+        rind[nnz++] = rind[j];
+      }
+    }
+  }
+  rptr[nrows] = nnz;
+
+  graph = CreateGraph();
+  graph->nvtxs  = nvtxs;
+  graph->nedges = 2*nnz;
+  graph->ncon   = 1;
+
+  xadj   = graph->xadj   = ismalloc(nvtxs+1, 0, "BuildBiGraph: xadj");
+  adjncy = graph->adjncy = imalloc(2*nnz, "BuildBiGraph: adjncy");
+
+  for (i=0; i<nrows; i++)
+    xadj[i] = rptr[i+1]-rptr[i];
+  for (j=0; j<nnz; j++)
+    xadj[nrows+rind[j]]++;
+  MAKECSR(i, nvtxs, xadj);
+
+  /* the lists of the columns, sorted by row */
+  for (i=0; i<nrows; i++) {
+    for (j=rptr[i]; j<rptr[i+1]; j++)
+      adjncy[xadj[nrows+rind[j]]++] = i;
+  }
+
+  /* the lists of the rows, sorted by column, xadj[nrows+c-1] is now the
+     start of the list of column c */
+  for (c=0; c<ncols; c++) {
+    for (j=(c == 0 ? nnz : xadj[nrows+c-1]); j<xadj[nrows+c]; j++) 
+      adjncy[xadj[adjncy[j]]++] = nrows+c;
+  }
+  SHIFTCSR(i, nvtxs, xadj);
+
+  gk_free((void **)&rptr, &rind, &mark, LTERM);
+
+  return graph;
+}
+
+
+/*************************************************************************/
+/*! This function sets params->nrows/ncols to the size of the bipartite
+    graph read from the file, checking them if they were given. */
+/*************************************************************************/
+void SetBiGraphSize(params_t *params, idx_t nrows, idx_t ncols)
+{
+  if ((params->nrows != -1 && params->nrows != nrows) || 
+      (params->ncols != -1 && params->ncols != ncols))
+    errexit("The file has %"PRIDX" rows and %"PRIDX" columns, but -nrows=%"PRIDX
+        " and -ncols=%"PRIDX" were given.\n", nrows, ncols, params->nrows, params->ncols);
+
+  params->nrows = nrows;
+  params->ncols = ncols;
+}
+
+
 bigraph_t *ReadBiGraph(params_t *params){
 	int i;
 	bigraph_t *bigraph;
 
 	bigraph = CreateBiGraph();
 
-	bigraph->super = ReadGraph(params);
+	switch (params->informat) {
+		case METIS_INFORMAT_MATRIX:
+			bigraph->super = ReadMatrixGraph(params);
+			break;
+		case METIS_INFORMAT_TRIPLES:
+			bigraph->super = ReadTriplesGraph(params);
+			break;
+		default:
+			if (IsBinaryGraph(params->filename))
+				bigraph->super = ReadBinaryGraph(params);
+			else
+				bigraph->super = ReadGraph(params);
+	}
 	bigraph->lastvtx = bigraph->super->nvtxs;
 	bigraph->nrows = params->nrows;
 	bigraph->ncols = params->ncols;
 	bigraph->area = bigraph->nrows * bigraph->ncols;
 	bigraph->nz = bigraph->super->nedges / 2;	/*TODO*/
+	bigraph->snz = bigraph->nz;
+	bigraph->sarea = bigraph->area;
 	bigraph->partible = 1;
 
 	if(bigraph->super->nvtxs != bigraph->nrows + bigraph->ncols){
@@ -200,8 +938,6 @@ bigraph_t *ReadBiGraph(params_t *params){
 		bigraph->clabel->label[i] = i;
 	bigraph->clabel->ref = 1;
 
-	bigraph->right = NULL;
-	bigraph->down = NULL;
 	bigraph->next = NULL;
 
 	return bigraph;
@@ -502,49 +1238,371 @@ void WriteMeshPartition(char *fname, idx_t nparts, idx_t ne, idx_t *epart,
 }
 
 
+/*************************************************************************/
+/*! This function opens a buffered text output file */
+/*************************************************************************/
+outbuf_t *OpenOutBuf(char *filename)
+{
+  outbuf_t *ob;
+
+  ob = (outbuf_t *)gk_malloc(sizeof(outbuf_t), "OpenOutBuf: ob");
+  ob->fpout    = gk_fopen(filename, "w", __func__);
+  ob->filename = gk_strdup(filename);
+  ob->buf      = gk_cmalloc(OUTBUF_SIZE, "OpenOutBuf: buf");
+  ob->len      = 0;
+
+  return ob;
+}
+
+
+/*************************************************************************/
+/*! This function writes the contents of the buffer to the file */
+/*************************************************************************/
+void OutBufFlush(outbuf_t *ob)
+{
+  if (ob->len > 0 && fwrite(ob->buf, 1, ob->len, ob->fpout) != ob->len)
+    errexit("Failed to write file %s\n", ob->filename);
+  ob->len = 0;
+}
+
+
+/*************************************************************************/
+/*! This function appends the decimal form of val followed by sep */
+/*************************************************************************/
+void OutBufIdx(outbuf_t *ob, idx_t val, char sep)
+{
+  char tmp[24], *buf;
+  size_t len, n=0;
+  uint64_t u;
+
+  if (ob->len + sizeof(tmp) > OUTBUF_SIZE)
+    OutBufFlush(ob);
+
+  buf = ob->buf;
+  len = ob->len;
+
+  if (val < 0) {
+    buf[len++] = '-';
+    u = -(uint64_t)val;
+  }
+  else {
+    u = (uint64_t)val;
+  }
+
+  /* the digits come out in reverse order */
+  do {
+    tmp[n++] = '0' + (char)(u%10);
+    u /= 10;
+  } while (u > 0);
+
+  while (n > 0)
+    buf[len++] = tmp[--n];
+  buf[len++] = sep;
+
+  ob->len = len;
+}
+
+
+/*************************************************************************/
+/*! This function appends a single character */
+/*************************************************************************/
+void OutBufChar(outbuf_t *ob, char c)
+{
+  if (ob->len == OUTBUF_SIZE)
+    OutBufFlush(ob);
+  ob->buf[ob->len++] = c;
+}
+
+
+/*************************************************************************/
+/*! This function flushes and closes a buffered text output file */
+/*************************************************************************/
+void CloseOutBuf(outbuf_t **r_ob)
+{
+  outbuf_t *ob = *r_ob;
+
+  OutBufFlush(ob);
+  gk_fclose(ob->fpout);
+  gk_free((void **)&ob->filename, &ob->buf, r_ob, LTERM);
+}
+
+
 /*************************************************************************/
 /*! This function writes out the permutation vector */
 /*************************************************************************/
 void WritePermutation(char *fname, idx_t *iperm, idx_t n)
 {
-  FILE *fpout;
+  outbuf_t *ob;
   idx_t i;
   char filename[MAXLINE];
 
   sprintf(filename, "%s.iperm", fname);
 
-  fpout = gk_fopen(filename, "w", __func__);
+  ob = OpenOutBuf(filename);
 
   for (i=0; i<n; i++)
-    fprintf(fpout, "%" PRIDX "\n", iperm[i]);
+    OutBufIdx(ob, iperm[i], '\n');
 
-  gk_fclose(fpout);
+  CloseOutBuf(&ob);
 }
 
 /* evison */
-void WriteDiags(char *fname, idx_t **rdiags, idx_t **cdiags, idx_t ndiags)
+void WriteDiags(char *fname, bdfdiags_t *diags)
 {
-	FILE *fpout;
-	idx_t i, j, nrows, ncols;
+	outbuf_t *ob;
+	idx_t i, j;
 	char filename[MAXLINE];
 
 	sprintf(filename, "%s.diags", fname);
 
-	fpout = gk_fopen(filename, "w", __func__);
+	ob = OpenOutBuf(filename);
 
-	fprintf(fpout, "%" PRIDX "\n", ndiags);
+	OutBufIdx(ob, diags->ndiags, '\n');
 
-	for (i = 0; i < ndiags; i++) {
-		nrows = rdiags[i][0];
-		ncols = cdiags[i][0];
-		fprintf(fpout, "%" PRIDX " " "%" PRIDX "\n", nrows, ncols);
-		for (j = 1; j <= nrows; j++)	fprintf(fpout, "%" PRIDX " ", rdiags[i][j]);
-		fprintf(fpout, "\n");
-		for (j = 1; j <= ncols; j++)	fprintf(fpout, "%" PRIDX " ", cdiags[i][j]);
-		fprintf(fpout, "\n");
+	for (i = 0; i < diags->ndiags; i++) {
+		OutBufIdx(ob, diags->rptr[i+1] - diags->rptr[i], ' ');
+		OutBufIdx(ob, diags->cptr[i+1] - diags->cptr[i], '\n');
+		for (j = diags->rptr[i]; j < diags->rptr[i+1]; j++)	OutBufIdx(ob, diags->rind[j], ' ');
+		OutBufChar(ob, '\n');
+		for (j = diags->cptr[i]; j < diags->cptr[i+1]; j++)	OutBufIdx(ob, diags->cind[j], ' ');
+		OutBufChar(ob, '\n');
 	}
 
-	gk_fclose(fpout);
+	CloseOutBuf(&ob);
+}
+
+
+/*************************************************************************/
+/*! This function writes out the permutation vector in the binary format
+    described in struct.h, so that it can be mapped into memory. nrows and
+    ncols are the sizes of the two sides of the bipartite graph. If varint
+    is set, iperm is delta-varint encoded instead. */
+/*************************************************************************/
+void WritePermutationBin(char *fname, idx_t *iperm, idx_t n, idx_t nrows, idx_t ncols, int varint)
+{
+  bdfhdr_t hdr;
+  FILE *fpout;
+  char filename[MAXLINE];
+
+  sprintf(filename, "%s.iperm.bin", fname);
+
+  memset((void *)&hdr, 0, sizeof(bdfhdr_t));
+  memcpy(hdr.magic, BINIPERM_MAGIC, 8);
+  hdr.version  = BINBDF_VERSION;
+  hdr.idxwidth = 8*sizeof(idx_t);
+  hdr.n        = n;
+  hdr.nrind    = nrows;
+  hdr.ncind    = ncols;
+  if (varint) {
+    hdr.flags  = BINBDF_VARINT;
+    hdr.fsize  = VARINT_FRAMESIZE;
+  }
+
+  fpout = gk_fopen(filename, "wb", __func__);
+
+  if (fwrite(&hdr, sizeof(bdfhdr_t), 1, fpout) != 1)
+    errexit("Failed to write file %s\n", filename);
+
+  if (varint)
+    WriteVarintArray(fpout, n, iperm, filename);
+  else if (fwrite(iperm, sizeof(idx_t), n, fpout) != (size_t)n)
+    errexit("Failed to write file %s\n", filename);
+
+  gk_fclose(fpout);
+}
+
+
+/*************************************************************************/
+/*! This function writes out the diagonal blocks in the binary format
+    described in struct.h. The rows and the columns of block i are stored
+    contiguously, so they can be used in place once the file is mapped. 
+    The arrays are laid out as in diags, so they are written at once.
+    If varint is set, the arrays are delta-varint encoded instead. */
+/*************************************************************************/
+void WriteDiagsBin(char *fname, bdfdiags_t *diags, int varint)
+{
+  size_t n;
+  bdfhdr_t hdr;
+  FILE *fpout;
+  char filename[MAXLINE];
+
+  sprintf(filename, "%s.diags.bin", fname);
+
+  memset((void *)&hdr, 0, sizeof(bdfhdr_t));
+  memcpy(hdr.magic, BINDIAGS_MAGIC, 8);
+  hdr.version  = BINBDF_VERSION;
+  hdr.idxwidth = 8*sizeof(idx_t);
+  hdr.n        = diags->ndiags;
+  hdr.nrind    = diags->nrind;
+  hdr.ncind    = diags->ncind;
+  if (varint) {
+    hdr.flags  = BINBDF_VARINT;
+    hdr.fsize  = VARINT_FRAMESIZE;
+  }
+
+  fpout = gk_fopen(filename, "wb", __func__);
+
+  if (fwrite(&hdr, sizeof(bdfhdr_t), 1, fpout) != 1)
+    errexit("Failed to write file %s\n", filename);
+
+  if (varint) {
+    WriteVarintArray(fpout, diags->ndiags+1, diags->rptr, filename);
+    WriteVarintArray(fpout, diags->ndiags+1, diags->cptr, filename);
+    WriteVarintArray(fpout, diags->nrind, diags->rind, filename);
+    WriteVarintArray(fpout, diags->ncind, diags->cind, filename);
+  }
+  else {
+    n = 2*(diags->ndiags+1) + diags->nrind + diags->ncind;
+    if (fwrite(diags->rptr, sizeof(idx_t), n, fpout) != n)
+      errexit("Failed to write file %s\n", filename);
+  }
+
+  gk_fclose(fpout);
+}
+
+
+/*************************************************************************/
+/*! This function writes the sub-matrix of each diagonal block to the file
+    <fname>.shard.<i>. A shard uses the header of the binary graph files 
+    with BINSHARD_MAGIC. nvtxs is the # of rows of the block and nedges its
+    # of non-zeros, and the header is followed by the CSR structure of the
+    rows, xadj[nvtxs+1], adjncy[nedges] and, if BINGRAPH_ADJWGT is set, 
+    adjwgt[nedges], with the columns numbered locally. rowids[nrows] and
+    colids[ncols] follow, and they map the local rows and columns to their
+    vertices in the graph, as in the .diags file. 
+    
+    For METIS_SHARDS_BLOCK the rows and columns that also belong to 
+    another block, i.e., the borders, are left out of the shard. */
+/*************************************************************************/
+void WriteShards(char *fname, graph_t *graph, idx_t nrows, idx_t ncols, 
+         bdfdiags_t *diags, idx_t shards)
+{
+  idx_t i, ii, j, k, c, snrows, sncols, nnz, hasewgt=0;
+  idx_t *xadj, *adjncy, *adjwgt, *rptr, *rind, *cptr, *cind;
+  idx_t *rcnts, *ccnts, *cmap, *rowids, *colids, *sxadj, *sadjncy, *sadjwgt;
+  binhdr_t hdr;
+  FILE *fpout;
+  char filename[MAXLINE];
+
+  xadj   = graph->xadj;
+  adjncy = graph->adjncy;
+  adjwgt = graph->adjwgt;
+
+  rptr = diags->rptr;
+  rind = diags->rind;
+  cptr = diags->cptr;
+  cind = diags->cind;
+
+  if (adjwgt) {
+    for (j=0; j<xadj[graph->nvtxs]; j++) {
+      if (adjwgt[j] != 1) {
+        hasewgt = 1;
+        break;
+      }
+    }
+  }
+
+  /* the # of blocks of each row and column, the borders are in more than one */
+  rcnts = ismalloc(nrows, 0, "WriteShards: rcnts");
+  ccnts = ismalloc(ncols, 0, "WriteShards: ccnts");
+  if (shards == METIS_SHARDS_BLOCK) {
+    for (j=0; j<diags->nrind; j++)
+      rcnts[rind[j]]++;
+    for (j=0; j<diags->ncind; j++)
+      ccnts[cind[j]-nrows]++;
+  }
+
+  cmap   = ismalloc(ncols, -1, "WriteShards: cmap");
+  rowids = imalloc(nrows, "WriteShards: rowids");
+  colids = imalloc(ncols, "WriteShards: colids");
+  sxadj  = imalloc(nrows+1, "WriteShards: sxadj");
+
+  for (i=0; i<diags->ndiags; i++) {
+    for (snrows=0, j=rptr[i]; j<rptr[i+1]; j++) {
+      if (rcnts[rind[j]] <= 1)
+        rowids[snrows++] = rind[j];
+    }
+    for (sncols=0, j=cptr[i]; j<cptr[i+1]; j++) {
+      if (ccnts[cind[j]-nrows] <= 1) {
+        cmap[cind[j]-nrows] = sncols;
+        colids[sncols++] = cind[j];
+      }
+    }
+
+    /* the columns of the graph are numbered after its rows */
+    sxadj[0] = 0;
+    for (nnz=0, ii=0; ii<snrows; ii++) {
+      for (j=xadj[rowids[ii]]; j<xadj[rowids[ii]+1]; j++) {
+        if (adjncy[j] >= nrows && cmap[adjncy[j]-nrows] != -1)
+          nnz++;
+      }
+      sxadj[ii+1] = nnz;
+    }
+
+    sadjncy = imalloc(nnz, "WriteShards: sadjncy");
+    sadjwgt = (hasewgt ? imalloc(nnz, "WriteShards: sadjwgt") : NULL);
+    for (k=0, ii=0; ii<snrows; ii++) {
+      for (j=xadj[rowids[ii]]; j<xadj[rowids[ii]+1]; j++) {
+        if (adjncy[j] >= nrows && (c = cmap[adjncy[j]-nrows]) != -1) {
+          if (hasewgt)
+            sadjwgt[k] = adjwgt[j];
+          sadjncy[k++] = c;
+        }
+      }
+    }
+
+    for (j=0; j<sncols; j++)
+      cmap[colids[j]-nrows] = -1;
+
+    memset((void *)&hdr, 0, sizeof(binhdr_t));
+    memcpy(hdr.magic, BINSHARD_MAGIC, 8);
+    hdr.version  = BINGRAPH_VERSION;
+    hdr.idxwidth = 8*sizeof(idx_t);
+    hdr.nvtxs    = snrows;
+    hdr.nedges   = nnz;
+    hdr.nrows    = snrows;
+    hdr.ncols    = sncols;
+    hdr.flags    = (hasewgt ? BINGRAPH_ADJWGT : 0);
+
+    sprintf(filename, "%s.shard.%"PRIDX, fname, i);
+    fpout = gk_fopen(filename, "wb", __func__);
+
+    if (fwrite(&hdr, sizeof(binhdr_t), 1, fpout) != 1 ||
+        fwrite(sxadj, sizeof(idx_t), snrows+1, fpout) != (size_t)(snrows+1) ||
+        fwrite(sadjncy, sizeof(idx_t), nnz, fpout) != (size_t)nnz ||
+        (hasewgt && fwrite(sadjwgt, sizeof(idx_t), nnz, fpout) != (size_t)nnz) ||
+        fwrite(rowids, sizeof(idx_t), snrows, fpout) != (size_t)snrows ||
+        fwrite(colids, sizeof(idx_t), sncols, fpout) != (size_t)sncols)
+      errexit("Failed to write file %s\n", filename);
+
+    gk_fclose(fpout);
+    gk_free((void **)&sadjncy, &sadjwgt, LTERM);
+  }
+
+  gk_free((void **)&rcnts, &ccnts, &cmap, &rowids, &colids, &sxadj, LTERM);
+}
+
+
+/*************************************************************************/
+/*! This function writes out the original ids of the vertices, the rows 
+    followed by the columns, one per line */
+/*************************************************************************/
+void WriteIds(char *fname, idx_t *rowids, idx_t nrows, idx_t *colids, idx_t ncols)
+{
+  outbuf_t *ob;
+  idx_t i;
+  char filename[MAXLINE];
+
+  sprintf(filename, "%s.ids", fname);
+
+  ob = OpenOutBuf(filename);
+
+  for (i=0; i<nrows; i++)
+    OutBufIdx(ob, rowids[i], '\n');
+  for (i=0; i<ncols; i++)
+    OutBufIdx(ob, colids[i], '\n');
+
+  CloseOutBuf(&ob);
 }
 
 
@@ -623,3 +1681,112 @@ void WriteGraph(graph_t *graph, char *filename)
 
   gk_fclose(fpout);
 }
+
+
+/*************************************************************************/
+/*! This function writes a graph into a binary CSR graph file, see binhdr_t.
+    Only single-constraint vertex weights are stored, vsize is dropped, and
+    the weights are stored only if they are not all 1. If varint is set,
+    the arrays are delta-varint encoded. */
+/*************************************************************************/
+void WriteBinaryGraph(graph_t *graph, idx_t nrows, idx_t ncols, int varint, char *filename)
+{
+  idx_t i, nvtxs, nedges;
+  idx_t *xadj, *adjwgt, *vwgt;
+  binhdr_t hdr;
+  FILE *fpout;
+
+  nvtxs  = graph->nvtxs;
+  xadj   = graph->xadj;
+  nedges = xadj[nvtxs];
+  vwgt   = graph->vwgt;
+  adjwgt = graph->adjwgt;
+
+  if (graph->ncon > 1)
+    errexit("The binary graph format does not support %"PRIDX" constraints.\n", graph->ncon);
+
+  memset((void *)&hdr, 0, sizeof(binhdr_t));
+  memcpy(hdr.magic, BINGRAPH_MAGIC, 8);
+  hdr.version  = BINGRAPH_VERSION;
+  hdr.idxwidth = 8*sizeof(idx_t);
+  hdr.nvtxs    = nvtxs;
+  hdr.nedges   = nedges;
+  hdr.nrows    = nrows;
+  hdr.ncols    = ncols;
+
+  /* determine if the graph has non-unity vwgt or adjwgt */
+  if (vwgt) {
+    for (i=0; i<nvtxs; i++) {
+      if (vwgt[i] != 1) {
+        hdr.flags |= BINGRAPH_VWGT;
+        break;
+      }
+    }
+  }
+  if (adjwgt) {
+    for (i=0; i<nedges; i++) {
+      if (adjwgt[i] != 1) {
+        hdr.flags |= BINGRAPH_ADJWGT;
+        break;
+      }
+    }
+  }
+
+  if (varint) {
+    hdr.flags |= BINGRAPH_VARINT;
+    hdr.fsize  = VARINT_FRAMESIZE;
+  }
+
+  fpout = gk_fopen(filename, "wb", __func__);
+
+  if (varint) {
+    if (fwrite(&hdr, sizeof(binhdr_t), 1, fpout) != 1)
+      errexit("Failed to write file %s\n", filename);
+    WriteVarintArray(fpout, nvtxs+1, xadj, filename);
+    WriteVarintArray(fpout, nedges, graph->adjncy, filename);
+    if (hdr.flags&BINGRAPH_VWGT) 
+      WriteVarintArray(fpout, nvtxs, vwgt, filename);
+    if (hdr.flags&BINGRAPH_ADJWGT) 
+      WriteVarintArray(fpout, nedges, adjwgt, filename);
+  }
+  else if (fwrite(&hdr, sizeof(binhdr_t), 1, fpout) != 1 ||
+      fwrite(xadj, sizeof(idx_t), nvtxs+1, fpout) != (size_t)(nvtxs+1) ||
+      fwrite(graph->adjncy, sizeof(idx_t), nedges, fpout) != (size_t)nedges ||
+      (hdr.flags&BINGRAPH_VWGT && 
+       fwrite(vwgt, sizeof(idx_t), nvtxs, fpout) != (size_t)nvtxs) ||
+      (hdr.flags&BINGRAPH_ADJWGT && 
+       fwrite(adjwgt, sizeof(idx_t), nedges, fpout) != (size_t)nedges))
+    errexit("Failed to write file %s\n", filename);
+
+  gk_fclose(fpout);
+}
+
+
+/*************************************************************************/
+/*! This function writes x[n] as frames of VARINT_FRAMESIZE delta-varint
+    encoded values. The frame offsets fptr[nframes+1] are written as 
+    int64_t, followed by the encoded bytes padded to a multiple of 8 */
+/*************************************************************************/
+void WriteVarintArray(FILE *fpout, idx_t n, idx_t *x, char *filename)
+{
+  idx_t nframes;
+  int64_t *fptr;
+  size_t nbytes, npad;
+  unsigned char *buf;
+
+  nframes = GK_VNFRAMES(n, VARINT_FRAMESIZE);
+  fptr    = (int64_t *)gk_malloc((nframes+1)*sizeof(int64_t), "WriteVarintArray: fptr");
+
+  nbytes = ivencodeframes(n, VARINT_FRAMESIZE, x, fptr, NULL);
+  npad   = (8 - nbytes%8)%8;
+
+  buf = (unsigned char *)gk_malloc(nbytes+npad+1, "WriteVarintArray: buf");
+  memset(buf+nbytes, 0, npad);
+  ivencodeframes(n, VARINT_FRAMESIZE, x, fptr, buf);
+
+  if (fwrite(fptr, sizeof(int64_t), nframes+1, fpout) != (size_t)(nframes+1) ||
+      fwrite(buf, 1, nbytes+npad, fpout) != nbytes+npad)
+    errexit("Failed to write file %s\n", filename);
+
+  gk_free((void **)&fptr, &buf, LTERM);
+}
@@ -16,15 +16,46 @@
 
 /* io.c */ 
 graph_t *ReadGraph(params_t *); 
+char *NextLine(char *s, char *end);
+idx_t CountGraphLines(char *s, char *end);
+void CountGraphChunk(graph_t *graph, char *s, char *end, idx_t v, idx_t readvs, 
+         idx_t readvw, idx_t readew);
+void ReadGraphChunk(graph_t *graph, char *s, char *end, idx_t v, idx_t readvs, 
+         idx_t readvw, idx_t readew);
+int ReadLineIdx(char **r_s, char *eol, idx_t *r_val);
+int IsBinaryGraph(char *filename);
+graph_t *ReadBinaryGraph(params_t *params);
+graph_t *ReadVarintGraph(params_t *params);
+char *ReadVarintArray(char *s, char *end, idx_t n, idx_t fsize, idx_t *x, char *filename);
+void FreeGraphMapping(params_t *params);
+void *MapFile(char *filename, size_t *r_size);
+void UnmapFile(void *map, size_t size);
+graph_t *ReadMatrixGraph(params_t *params);
+graph_t *ReadTriplesGraph(params_t *params);
+idx_t *RemapIds(idx_t n, idx_t *ids, idx_t *r_nids);
+graph_t *BuildBiGraph(idx_t nrows, idx_t ncols, idx_t npairs, idx_t *rows, idx_t *cols);
+void SetBiGraphSize(params_t *params, idx_t nrows, idx_t ncols);
 bigraph_t *ReadBiGraph(params_t *);
 mesh_t *ReadMesh(params_t *); 
 void ReadTPwgts(params_t *params, idx_t ncon);
 void ReadPOVector(graph_t *graph, char *filename, idx_t *vector);
+outbuf_t *OpenOutBuf(char *filename);
+void OutBufFlush(outbuf_t *ob);
+void OutBufIdx(outbuf_t *ob, idx_t val, char sep);
+void OutBufChar(outbuf_t *ob, char c);
+void CloseOutBuf(outbuf_t **r_ob);
 void WritePartition(char *, idx_t *, idx_t, idx_t);
 void WriteMeshPartition(char *, idx_t, idx_t, idx_t *, idx_t, idx_t *);
 void WritePermutation(char *, idx_t *, idx_t);
-void WriteDiags(char *fname, idx_t **rdiags, idx_t **cdiags, idx_t ndiags);	/* evison */
+void WriteDiags(char *fname, bdfdiags_t *diags);	/* evison */
+void WritePermutationBin(char *fname, idx_t *iperm, idx_t n, idx_t nrows, idx_t ncols, int varint);
+void WriteDiagsBin(char *fname, bdfdiags_t *diags, int varint);
+void WriteShards(char *fname, graph_t *graph, idx_t nrows, idx_t ncols, 
+         bdfdiags_t *diags, idx_t shards);
+void WriteIds(char *fname, idx_t *rowids, idx_t nrows, idx_t *colids, idx_t ncols);
 void WriteGraph(graph_t *graph, char *filename);
+void WriteBinaryGraph(graph_t *graph, idx_t nrows, idx_t ncols, int varint, char *filename);
+void WriteVarintArray(FILE *fpout, idx_t n, idx_t *x, char *filename);
 
 
 /* smbfactor.c */
@@ -47,8 +78,17 @@ void NDPrintInfo(params_t *params, graph_t *graph);
 void NDReportResults(params_t *params, graph_t *graph, idx_t *perm, idx_t *iperm);
 
 /* rbbdf.c */
+void BDFSetOptions(params_t *params, idx_t *options);
+void BDFWriteResults(params_t *params, char *fname, bigraph_t *bigraph, idx_t *iperm,
+         bdfdiags_t *diags);
 void BDFPrintInfo(params_t *params, bigraph_t *bigraph);
-void BDFReportResults(params_t *params, bigraph_t *bigraph);
+void BDFReportResults(params_t *params, bigraph_t *bigraph, bdfstats_t *stats);
+
+/* server.c */
+void BDFServe(params_t *params, bigraph_t *bigraph);
+int ServeBDFJobs(params_t *params, bigraph_t *bigraph, FILE *fpin, FILE *fpout);
+int ParseBDFJob(params_t *params, char *line, bdfjob_t *job, char *errmsg);
+void RunBDFJob(params_t *params, bigraph_t *bigraph, bdfjob_t *job, FILE *fpout);
 
 /* mpmetis.c */
 void MPPrintInfo(params_t *params, mesh_t *mesh);
@@ -59,6 +99,14 @@ void MPReportResults(params_t *params, mesh_t *mesh, idx_t *epart, idx_t *npart,
 void M2GPrintInfo(params_t *params, mesh_t *mesh);
 void M2GReportResults(params_t *params, mesh_t *mesh, graph_t *graph);
 
+/* edges2bin.c */
+void SortEdges(size_t n, edge_t *edges);
+size_t UniqueEdges(size_t n, edge_t *edges);
+void SpillEdgeRun(char *fname, idx_t irun, size_t n, edge_t *edges);
+int NextRunEdge(edgerun_t *run, edge_t *r_edge);
+void WriteEdgeRuns(char *fname, idx_t nruns, size_t n, edge_t *edges, idx_t nvtxs,
+         idx_t nrows, idx_t ncols, size_t *r_nedges);
+
 /* stat.c */
 void ComputePartitionInfo(params_t *params, graph_t *graph, idx_t *where);
 
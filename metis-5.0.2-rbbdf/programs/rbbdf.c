@@ -1,6 +1,5 @@
 
 #include "metisbin.h"
-#include "bmetis.h"
 
 int main(int argc, char *argv[])
 {
@@ -10,10 +9,8 @@ int main(int argc, char *argv[])
   	params_t *params;
   	int status, i, j;
 
-  	/* rdiags[i][0] and cdiags[i][0] saves the length of each array
-  	 * excluding the first value */
-  	idx_t **rdiags, **cdiags;
-  	idx_t ndiags;
+  	bdfdiags_t *diags;
+  	bdfstats_t stats;
 
   	params = parse_cmdline(argc, argv);
 
@@ -27,30 +24,20 @@ int main(int argc, char *argv[])
   		return -1;
   	}
 
-  	BDFPrintInfo(params, bigraph);
+  	if (params->server) {
+  		/* the graph stays in memory for all the jobs */
+  		BDFServe(params, bigraph);
 
-    METIS_SetDefaultOptions(options);
-    /*User specific parameters*/
-	options[METIS_OPTION_CTYPE]    = params->ctype;
-	options[METIS_OPTION_IPTYPE]   = params->iptype;
-	options[METIS_OPTION_RTYPE]    = params->rtype;
-	options[METIS_OPTION_CCORDER]  = params->ccorder;
-	options[METIS_OPTION_SEED]     = params->seed;
-	options[METIS_OPTION_DBGLVL]   = params->dbglvl;
-	options[METIS_OPTION_DENSITY] = params->density * DIVIDER;
-	options[METIS_OPTION_NROWS] = params->nrows;
-	options[METIS_OPTION_NCOLS] = params->ncols;
-	options[METIS_OPTION_KAPPA] = params->kappa;
-	options[METIS_OPTION_NDIAGS] = params->ndiags;
+  		FreeBiGraph((ctrl_t*)NULL, &bigraph);
+  		FreeGraphMapping(params);
+  		gk_free((void **)&params->filename, &params->tpwgtsfile, &params->tpwgts,
+  		  &params->ubvec, &params->rowids, &params->colids, &params->socket, &params, LTERM);
+  		return 0;
+  	}
 
-	/*Inner parameters*/
-	options[METIS_OPTION_COMPRESS] = params->compress;
-	options[METIS_OPTION_UFACTOR]  = params->ufactor;
-	options[METIS_OPTION_PFACTOR]  = params->pfactor;
-	options[METIS_OPTION_NCUTS] = params->ncuts;
-	options[METIS_OPTION_NSEPS]    = params->nseps;
-	options[METIS_OPTION_NITER]    = params->niter;
-	options[METIS_OPTION_OBJTYPE] = params->objtype;
+  	BDFPrintInfo(params, bigraph);
+
+	BDFSetOptions(params, options);
 
 	perm  = imalloc(bigraph->super->nvtxs, "main: perm");
   	iperm = imalloc(bigraph->super->nvtxs, "main: iperm");
@@ -58,27 +45,13 @@ int main(int argc, char *argv[])
 	gk_malloc_init();
 	gk_startcputimer(params->parttimer);
 
-	/* Initialize my global paramters */
-	gk_clearcputimer(_parttimer);
-	gk_clearcputimer(_nztimer);
-	_totalcheck = 0;
-	_firsthit = 0;
-	_maxarea = -1;
-	_maxnz = -1;
-	_minarea = 700000000000;
-	_minnz = 300000000;
-	_avgarea = 0;
-	_avgnz = 0;
-	_maxdense = 0;
-	_mindense = 0;
-
   	/* All the memory that is not allocated in this file should be allocated after
   	 * gk_malloc_init() and be freed before gk_GetCurMemoryUsed().
   	 * Memory that is allocated in this file should be free in the end of main()*/
   	status = METIS_NodeBDF(&bigraph->super->nvtxs, bigraph->super->xadj, bigraph->super->adjncy,
   			bigraph->super->vwgt, bigraph->nrows, bigraph->ncols,
   			options, bigraph->rlabel->label, bigraph->rlabel->ref, bigraph->clabel->label, bigraph->clabel->ref,
-  			&rdiags, &cdiags, &ndiags, perm, iperm);
+  			&diags, perm, iperm, &stats);
 
   	gk_stopcputimer(params->parttimer);
 
@@ -94,30 +67,80 @@ int main(int argc, char *argv[])
 		if (! params->nooutput) {
 	  		/* Write the permutation */
 	  		gk_startcputimer(params->iotimer);
-	  		WritePermutation(params->filename, iperm, bigraph->super->nvtxs);
-	  		WriteDiags(params->filename, rdiags, cdiags, ndiags);
+	  		BDFWriteResults(params, params->filename, bigraph, iperm, diags);
 	  		gk_stopcputimer(params->iotimer);
 		}
-		BDFReportResults(params, bigraph);
+		BDFReportResults(params, bigraph, &stats);
 	}
 
 	/* free inner function memory */
-	for (i = 0; i < ndiags; i++) {
-		free((void*)rdiags[i]);
-		free((void*)cdiags[i]);
-	}
-	free((void*)rdiags);
-	free((void*)cdiags);
+	METIS_Free(diags);
 
 	/* free memroy allocated in this function */
 	FreeBiGraph((ctrl_t*)NULL, &bigraph);
+	FreeGraphMapping(params);
 	gk_free((void **)&perm, &iperm, LTERM);
 	gk_free((void **)&params->filename, &params->tpwgtsfile, &params->tpwgts,
-	  &params->ubvec, &params, LTERM);
+	  &params->ubvec, &params->rowids, &params->colids, &params, LTERM);
 
 	return status;
 }
 
+/*************************************************************************/
+/*! This function fills the options of METIS_NodeBDF from the parameters */
+/*************************************************************************/
+void BDFSetOptions(params_t *params, idx_t *options)
+{
+    METIS_SetDefaultOptions(options);
+    /*User specific parameters*/
+	options[METIS_OPTION_CTYPE]    = params->ctype;
+	options[METIS_OPTION_IPTYPE]   = params->iptype;
+	options[METIS_OPTION_RTYPE]    = params->rtype;
+	options[METIS_OPTION_CCORDER]  = params->ccorder;
+	options[METIS_OPTION_SEED]     = params->seed;
+	options[METIS_OPTION_DBGLVL]   = params->dbglvl;
+	options[METIS_OPTION_DENSITY] = params->density * DIVIDER;
+	options[METIS_OPTION_NROWS] = params->nrows;
+	options[METIS_OPTION_NCOLS] = params->ncols;
+	options[METIS_OPTION_KAPPA] = params->kappa;
+	options[METIS_OPTION_NDIAGS] = params->ndiags;
+	options[METIS_OPTION_NTHREADS] = params->nthreads;
+	options[METIS_OPTION_SELECT] = params->select;
+	options[METIS_OPTION_INHERIT] = params->inherit;
+
+	/*Inner parameters*/
+	options[METIS_OPTION_COMPRESS] = params->compress;
+	options[METIS_OPTION_UFACTOR]  = params->ufactor;
+	options[METIS_OPTION_PFACTOR]  = params->pfactor;
+	options[METIS_OPTION_NCUTS] = params->ncuts;
+	options[METIS_OPTION_NSEPS]    = params->nseps;
+	options[METIS_OPTION_NITER]    = params->niter;
+	options[METIS_OPTION_OBJTYPE] = params->objtype;
+}
+
+/*************************************************************************/
+/*! This function writes the ordering to the files prefixed by fname, in
+    the formats selected by the parameters */
+/*************************************************************************/
+void BDFWriteResults(params_t *params, char *fname, bigraph_t *bigraph, idx_t *iperm,
+		bdfdiags_t *diags)
+{
+	if (params->outfmt != METIS_OUTFMT_TEXT) {
+		WritePermutationBin(fname, iperm, bigraph->super->nvtxs, 
+				bigraph->nrows, bigraph->ncols, params->outfmt == METIS_OUTFMT_VARINT);
+		WriteDiagsBin(fname, diags, params->outfmt == METIS_OUTFMT_VARINT);
+	}
+	else {
+		WritePermutation(fname, iperm, bigraph->super->nvtxs);
+		WriteDiags(fname, diags);
+	}
+	if (params->shards != METIS_SHARDS_NONE)
+		WriteShards(fname, bigraph->super, bigraph->nrows, bigraph->ncols, 
+				diags, params->shards);
+	if (params->rowids)
+		WriteIds(fname, params->rowids, params->nrows, params->colids, params->ncols);
+}
+
 /*************************************************************************/
 /*! This function prints run parameters */
 /*************************************************************************/
@@ -141,13 +164,17 @@ void BDFPrintInfo(params_t *params, bigraph_t *bigraph)
 		params->seed, params->dbglvl, (params->ccorder  ? "YES" : "NO"), (params->compress ? "YES" : "NO"));
 	printf(" density=%.4f, kappa=%d, nrows=%d, ncols=%d, area=%lld\n",
 			params->density, params->kappa, params->nrows, params->ncols, params->nrows*params->ncols);
+	printf(" nthreads=%"PRIDX", select=%s, informat=%s, outfmt=%s, shards=%s\n", params->nthreads, 
+			selectnames[params->select], informatnames[params->informat], outfmtnames[params->outfmt],
+			shardsnames[params->shards]);
 
 	printf("\n");
 	printf("Inner Options ---------------------------------------------------------------\n");
 	printf(" niter=%"PRIDX", nseps=%"PRIDX", ncuts=%"PRIDX", nparts=%"PRIDX"\n", params->niter,
 			params->nseps, params->ncuts, params->nparts);
-	printf(" ufactor=%.3f, pfactor=%.2f, nooutput=%s, objtype=%s\n\n", I2RUBFACTOR(params->ufactor),
-			0.1*params->pfactor, (params->nooutput ? "YES" : "NO"), objtypenames[params->objtype] );
+	printf(" ufactor=%.3f, pfactor=%.2f, nooutput=%s, objtype=%s, inherit=%s\n\n", I2RUBFACTOR(params->ufactor),
+			0.1*params->pfactor, (params->nooutput ? "YES" : "NO"), objtypenames[params->objtype],
+			(params->inherit ? "YES" : "NO"));
 	printf("\n");
 	printf("Node-based Nested Dissection ------------------------------------------------\n");
 }
@@ -156,7 +183,7 @@ void BDFPrintInfo(params_t *params, bigraph_t *bigraph)
 /*************************************************************************/
 /*! This function does any post-ordering reporting */
 /*************************************************************************/
-void BDFReportResults(params_t *params, bigraph_t *bigraph)
+void BDFReportResults(params_t *params, bigraph_t *bigraph, bdfstats_t *stats)
 {
 	gk_startcputimer(params->reporttimer);
 	gk_stopcputimer(params->reporttimer);
@@ -165,22 +192,22 @@ void BDFReportResults(params_t *params, bigraph_t *bigraph)
 	printf("  I/O:          \t\t %7.3"PRREAL" sec\n", gk_getcputimer(params->iotimer));
 	printf("  Ordering:     \t\t %7.3"PRREAL" sec   (METIS time)\n", gk_getcputimer(params->parttimer));
 	printf("  Reporting:    \t\t %7.3"PRREAL" sec\n", gk_getcputimer(params->reporttimer));
-	printf("  Partitioning: \t\t %7.3"PRREAL" sec\n", gk_getcputimer(_parttimer));
-	printf("  NZStating:    \t\t %7.3"PRREAL" sec\n", gk_getcputimer(_nztimer));
+	printf("  Partitioning: \t\t %7.3"PRREAL" sec\n", gk_getcputimer(stats->parttimer));
+	printf("  NZStating:    \t\t %7.3"PRREAL" sec\n", gk_getcputimer(stats->nztimer));
 	printf("\nMemory Information ----------------------------------------------------------\n");
 	printf("  Max memory used:\t\t %7.3"PRREAL" MB\n", (real_t)(params->maxmemory/(1024.0*1024.0)));
 	printf("\nHeuristic Information -------------------------------------------------------\n");
-	printf("  TotalCheck:   \t\t %"PRIDX"\n", _totalcheck);
-	printf("  FirstHit:     \t\t %"PRIDX"\n", _firsthit);
-	printf("  FirstHitRate: \t\t %7.3"PRREAL"\n", (_totalcheck == 0 ? 1 : (real_t)1.0*_firsthit/_totalcheck));
-	printf("  MaxArea:      \t\t %"PRIDX"\n", _maxarea);
-	printf("  MaxNonZeros:  \t\t %"PRIDX"\n", _maxnz);
-	printf("  MinArea:      \t\t %"PRIDX"\n", _minarea);
-	printf("  MinNonZeors:  \t\t %"PRIDX"\n", _minnz);
-	printf("  AvgArea:      \t\t %7.3"PRREAL"\n", _avgarea);
-	printf("  AvgNz:        \t\t %7.3"PRREAL"\n", _avgnz);
-	printf("  MaxDense:     \t\t %7.6"PRREAL"\n", _maxdense);
-	printf("  MinDense:     \t\t %7.6"PRREAL"\n", _mindense);
+	printf("  TotalCheck:   \t\t %"PRIDX"\n", stats->totalcheck);
+	printf("  FirstHit:     \t\t %"PRIDX"\n", stats->firsthit);
+	printf("  FirstHitRate: \t\t %7.3"PRREAL"\n", (stats->totalcheck == 0 ? 1 : (real_t)1.0*stats->firsthit/stats->totalcheck));
+	printf("  MaxArea:      \t\t %"PRIDX"\n", stats->maxarea);
+	printf("  MaxNonZeros:  \t\t %"PRIDX"\n", stats->maxnz);
+	printf("  MinArea:      \t\t %"PRIDX"\n", stats->minarea);
+	printf("  MinNonZeors:  \t\t %"PRIDX"\n", stats->minnz);
+	printf("  AvgArea:      \t\t %7.3"PRREAL"\n", stats->avgarea);
+	printf("  AvgNz:        \t\t %7.3"PRREAL"\n", stats->avgnz);
+	printf("  MaxDense:     \t\t %7.6"PRREAL"\n", stats->maxdense);
+	printf("  MinDense:     \t\t %7.6"PRREAL"\n", stats->mindense);
 	printf("******************************************************************************\n");
 
 }
@@ -0,0 +1,295 @@
+/*
+ * server.c
+ *
+ * This file contains the server mode of rbbdf. The bipartite graph is read
+ * once and then it is ordered for each job that comes in, either on stdin
+ * or over a UNIX socket. A job overrides the density, ndiags and seed of the
+ * command line and names the prefix of its output files. Since
+ * METIS_NodeBDF() keeps no global state, the jobs run concurrently on a
+ * pool of OpenMP threads and share the read-only graph.
+ *
+ */
+
+#include "metisbin.h"
+
+#ifndef __MSC__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+
+/*************************************************************************/
+/*! This function serves the jobs on stdin, or on params->socket, until
+    the end of the input or a shutdown line */
+/*************************************************************************/
+void BDFServe(params_t *params, bigraph_t *bigraph)
+{
+#ifdef __MSC__
+  errexit("The server mode is not supported on this platform.\n");
+#else
+  int sfd, cfd, done=0;
+  struct sockaddr_un addr;
+  FILE *fpin=NULL, *fpout=NULL;
+
+  if (params->nworkers < 1)
+    params->nworkers = 1;
+
+  if (params->socket == NULL) {
+    /* the responses take stdout over, the orderings report to stderr */
+    fflush(stdout);
+    if ((fpout = fdopen(dup(STDOUT_FILENO), "w")) == NULL ||
+        dup2(STDERR_FILENO, STDOUT_FILENO) == -1)
+      errexit("Failed to redirect stdout: %s\n", strerror(errno));
+
+    BDFPrintInfo(params, bigraph);
+    ServeBDFJobs(params, bigraph, stdin, fpout);
+
+    fclose(fpout);
+    return;
+  }
+
+  BDFPrintInfo(params, bigraph);
+
+  if (strlen(params->socket) >= sizeof(addr.sun_path))
+    errexit("The socket path %s is too long.\n", params->socket);
+
+  /* a client that goes away must not take the server down */
+  signal(SIGPIPE, SIG_IGN);
+
+  memset((void *)&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, params->socket);
+  unlink(params->socket);
+
+  if ((sfd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+      bind(sfd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+      listen(sfd, 16) == -1)
+    errexit("Failed to listen on %s: %s\n", params->socket, strerror(errno));
+
+  printf("Listening on %s\n", params->socket);
+  fflush(stdout);
+
+  /* the connections are served one after the other, the jobs of each
+     one run concurrently */
+  while (!done) {
+    if ((cfd = accept(sfd, NULL, NULL)) == -1) {
+      if (errno == EINTR)
+        continue;
+      errexit("Failed to accept on %s: %s\n", params->socket, strerror(errno));
+    }
+
+    if ((fpin = fdopen(cfd, "r")) == NULL || (fpout = fdopen(dup(cfd), "w")) == NULL)
+      errexit("Failed to open a connection on %s: %s\n", params->socket, strerror(errno));
+
+    done = ServeBDFJobs(params, bigraph, fpin, fpout);
+
+    fclose(fpin);
+    fclose(fpout);
+  }
+
+  close(sfd);
+  unlink(params->socket);
+#endif
+}
+
+
+/*************************************************************************/
+/*! This function reads the jobs from fpin, one per line, and runs them on
+    params->nworkers threads. The response of each job is written to fpout
+    when it is done, so they may come out of order. It returns 1 if the
+    server has to shut down. */
+/*************************************************************************/
+int ServeBDFJobs(params_t *params, bigraph_t *bigraph, FILE *fpin, FILE *fpout)
+{
+  idx_t njobs=0;
+  int shutdown=0;
+  size_t lnlen=0;
+  char *line=NULL, *s, errmsg[512];
+  bdfjob_t job;
+
+  #pragma omp parallel num_threads(params->nworkers)
+  #pragma omp single
+  {
+    while (gk_getline(&line, &lnlen, fpin) != -1) {
+      for (s=line; isspace((int)*s); s++);
+      if (*s == '\0' || *s == '#')
+        continue;
+
+      if (strncmp(s, "shutdown", 8) == 0) {
+        shutdown = 1;
+        break;
+      }
+
+      job.id = ++njobs;
+      if (!ParseBDFJob(params, s, &job, errmsg)) {
+        #pragma omp critical (bdfserver)
+        {
+          fprintf(fpout, "job %"PRIDX" error %s\n", job.id, errmsg);
+          fflush(fpout);
+        }
+        continue;
+      }
+
+      #pragma omp task firstprivate(job)
+      RunBDFJob(params, bigraph, &job, fpout);
+    }
+  }
+
+  gk_free((void **)&line, LTERM);
+
+  return shutdown;
+}
+
+
+/*************************************************************************/
+/*! This function parses the key=value pairs of a job. The parameters that
+    are not given are taken from the command line. It returns 0 and the
+    reason in errmsg if the job is not valid. */
+/*************************************************************************/
+int ParseBDFJob(params_t *params, char *line, bdfjob_t *job, char *errmsg)
+{
+  int gotdensity=0, gotndiags=0;
+  char *key, *value, *end;
+
+  job->density = params->density;
+  job->ndiags  = params->ndiags;
+  job->seed    = params->seed;
+  job->outname = NULL;
+
+  for (key=strtok(line, " \t\r\n"); key != NULL; key=strtok(NULL, " \t\r\n")) {
+    if ((value = strchr(key, '=')) == NULL) {
+      sprintf(errmsg, "%.100s is not a key=value pair", key);
+      goto ERROR;
+    }
+    *value++ = '\0';
+
+    if (strcmp(key, "out") == 0) {
+      gk_free((void **)&job->outname, LTERM);
+      job->outname = gk_strdup(value);
+    }
+    else if (strcmp(key, "density") == 0) {
+      job->density = (real_t)strtod(value, &end);
+      if (*end != '\0' || job->density <= 0.0 || job->density > 1.0) {
+        sprintf(errmsg, "invalid density %.100s", value);
+        goto ERROR;
+      }
+      gotdensity = 1;
+    }
+    else if (strcmp(key, "ndiags") == 0) {
+      job->ndiags = strtoidx(value, &end, 10);
+      if (*end != '\0' || job->ndiags < 1) {
+        sprintf(errmsg, "invalid ndiags %.100s", value);
+        goto ERROR;
+      }
+      gotndiags = 1;
+    }
+    else if (strcmp(key, "seed") == 0) {
+      job->seed = strtoidx(value, &end, 10);
+      if (*end != '\0') {
+        sprintf(errmsg, "invalid seed %.100s", value);
+        goto ERROR;
+      }
+    }
+    else if (strcmp(key, "id") == 0) {
+      job->id = strtoidx(value, &end, 10);
+      if (*end != '\0') {
+        sprintf(errmsg, "invalid id %.100s", value);
+        goto ERROR;
+      }
+    }
+    else {
+      sprintf(errmsg, "unknown key %.100s", key);
+      goto ERROR;
+    }
+  }
+
+  /* as on the command line, ndiags takes precedence over density */
+  if (gotdensity && !gotndiags)
+    job->ndiags = -1;
+
+  if (job->density <= 0.0) {
+    sprintf(errmsg, "density is required");
+    goto ERROR;
+  }
+  if (job->outname == NULL && !params->nooutput) {
+    sprintf(errmsg, "out is required");
+    goto ERROR;
+  }
+
+  return 1;
+
+ERROR:
+  gk_free((void **)&job->outname, LTERM);
+  return 0;
+}
+
+
+/*************************************************************************/
+/*! This function orders the graph for a job, writes its output files and
+    its response */
+/*************************************************************************/
+void RunBDFJob(params_t *params, bigraph_t *bigraph, bdfjob_t *job, FILE *fpout)
+{
+  idx_t options[METIS_NOPTIONS];
+  idx_t *perm=NULL, *iperm=NULL;
+  int status=METIS_OK;
+  double tmr;
+  char *dirname, *s, errmsg[512];
+  bdfdiags_t *diags=NULL;
+  bdfstats_t stats;
+
+  tmr = gk_WClockSeconds();
+  errmsg[0] = '\0';
+
+  /* the writers exit on errors, so the output directory is checked first */
+  if (!params->nooutput) {
+    dirname = gk_strdup(job->outname);
+    if ((s = strrchr(dirname, '/')) != NULL)
+      *(s == dirname ? s+1 : s) = '\0';
+    else
+      strcpy(dirname, ".");
+#ifndef __MSC__
+    if (access(dirname, W_OK) != 0)
+      sprintf(errmsg, "cannot write to %.200s: %.100s", dirname, strerror(errno));
+#endif
+    gk_free((void **)&dirname, LTERM);
+  }
+
+  if (errmsg[0] == '\0') {
+    BDFSetOptions(params, options);
+    options[METIS_OPTION_DENSITY] = job->density * DIVIDER;
+    options[METIS_OPTION_NDIAGS]  = job->ndiags;
+    options[METIS_OPTION_SEED]    = job->seed;
+
+    perm  = imalloc(bigraph->super->nvtxs, "RunBDFJob: perm");
+    iperm = imalloc(bigraph->super->nvtxs, "RunBDFJob: iperm");
+
+    /* the graph is shared by all the jobs, METIS_NodeBDF() does not change it */
+    status = METIS_NodeBDF(&bigraph->super->nvtxs, bigraph->super->xadj, bigraph->super->adjncy,
+                 bigraph->super->vwgt, bigraph->nrows, bigraph->ncols, options,
+                 bigraph->rlabel->label, bigraph->rlabel->ref,
+                 bigraph->clabel->label, bigraph->clabel->ref,
+                 &diags, perm, iperm, &stats);
+
+    if (status != METIS_OK)
+      sprintf(errmsg, "METIS returned %d", status);
+    else if (!params->nooutput)
+      BDFWriteResults(params, job->outname, bigraph, iperm, diags);
+  }
+
+  #pragma omp critical (bdfserver)
+  {
+    if (errmsg[0] != '\0')
+      fprintf(fpout, "job %"PRIDX" error %s\n", job->id, errmsg);
+    else
+      fprintf(fpout, "job %"PRIDX" ok %s ndiags=%"PRIDX" density=%.6f time=%.3f\n",
+          job->id, (job->outname ? job->outname : "-"), diags->ndiags,
+          (stats.avgarea > 0 ? stats.avgnz/stats.avgarea : 0.0), gk_WClockSeconds()-tmr);
+    fflush(fpout);
+  }
+
+  METIS_Free(diags);
+  gk_free((void **)&perm, &iperm, &job->outname, LTERM);
+}
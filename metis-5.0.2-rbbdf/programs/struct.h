@@ -69,8 +69,116 @@ typedef struct {
   idx_t ncols;
   idx_t kappa;
   idx_t ndiags;
+  idx_t nthreads;
+  idx_t select;
+
+  idx_t informat;
+  idx_t outfmt;
+  idx_t shards;
+
+  idx_t server;         /*!< Serve jobs instead of a single ordering */
+  char *socket;         /*!< The UNIX socket of the server, stdin if NULL */
+  idx_t nworkers;       /*!< The # of jobs the server runs concurrently */
+
+  idx_t inherit;        /*!< Coarsen the blocks by restricting the hierarchy of their parent */
+
+  void *mapping;        /*!< The mapped binary graph file, if any */
+  size_t mapsize;
+
+  idx_t *rowids;        /*!< The original ids of the rows, if remapped */
+  idx_t *colids;        /*!< The original ids of the columns, if remapped */
 
 } params_t;
 
 
+/*************************************************************************/
+/*! The header of a binary CSR graph file. It is followed by xadj[nvtxs+1],
+    adjncy[nedges], and, depending on flags, vwgt[nvtxs] and adjwgt[nedges],
+    all stored as idx_t in the byte order of the machine that wrote them. 
+    The header is 64 bytes, so the arrays are aligned when the file is
+    mapped into memory. 
+    
+    With BINGRAPH_VARINT each array is instead stored as frames of fsize 
+    delta-varint encoded values, see WriteVarintArray(). */
+/*************************************************************************/
+typedef struct {
+  char magic[8];        /*!< BINGRAPH_MAGIC, not null terminated */
+  int32_t version;      /*!< BINGRAPH_VERSION */
+  int32_t idxwidth;     /*!< The width of idx_t in bits */
+  int64_t nvtxs;
+  int64_t nedges;       /*!< The length of adjncy, i.e., twice the # of edges */
+  int64_t nrows;        /*!< The # of row vertices of a bipartite graph, -1 if unknown */
+  int64_t ncols;        /*!< The # of column vertices of a bipartite graph, -1 if unknown */
+  int32_t flags;        /*!< BINGRAPH_VWGT | BINGRAPH_ADJWGT | BINGRAPH_VARINT */
+  int32_t fsize;        /*!< The # of values of the varint frames */
+  int32_t reserved[2];
+} binhdr_t;
+
+
+/*************************************************************************/
+/*! The header of the binary .iperm.bin and .diags.bin files of rbbdf. The
+    .iperm.bin file is followed by iperm[n]. The .diags.bin file stores the
+    n diagonal blocks in CSR form, rptr[n+1] and cptr[n+1] followed by 
+    rind[nrind] and cind[ncind], with the rows of block i being
+    rind[rptr[i]..rptr[i+1]-1], and similarly for its columns. With 
+    BINBDF_VARINT the arrays are delta-varint encoded as in the binary 
+    graph files. */
+/*************************************************************************/
+typedef struct {
+  char magic[8];        /*!< BINIPERM_MAGIC or BINDIAGS_MAGIC, not null terminated */
+  int32_t version;      /*!< BINBDF_VERSION */
+  int32_t idxwidth;     /*!< The width of idx_t in bits */
+  int64_t n;            /*!< The length of iperm or the # of diagonal blocks */
+  int64_t nrind;        /*!< The # of rows of the graph or of rind */
+  int64_t ncind;        /*!< The # of columns of the graph or of cind */
+  int32_t flags;        /*!< BINBDF_VARINT */
+  int32_t fsize;        /*!< The # of values of the varint frames */
+  int64_t reserved[2];
+} bdfhdr_t;
+
+
+/*************************************************************************/
+/*! A directed edge of the edge lists of edges2bin */
+/*************************************************************************/
+typedef struct {
+  idx_t u, v;
+} edge_t;
+
+
+/*************************************************************************/
+/*! A sorted run of edges that edges2bin reads back from a file, or from
+    memory if fpin is NULL */
+/*************************************************************************/
+typedef struct {
+  FILE *fpin;
+  edge_t *buf;
+  size_t size;          /*!< The capacity of buf */
+  size_t len;           /*!< The # of edges in buf */
+  size_t pos;           /*!< The next edge of buf */
+} edgerun_t;
+
+
+/*************************************************************************/
+/*! A job of the rbbdf server, the parameters that it overrides */
+/*************************************************************************/
+typedef struct {
+  idx_t id;             /*!< The id echoed in the response */
+  real_t density;
+  idx_t ndiags;
+  idx_t seed;
+  char *outname;        /*!< The prefix of the output files */
+} bdfjob_t;
+
+
+/*************************************************************************/
+/*! A buffered text output file */
+/*************************************************************************/
+typedef struct {
+  FILE *fpout;
+  char *filename;
+  char *buf;
+  size_t len;           /*!< The # of bytes in buf */
+} outbuf_t;
+
+
 #endif 